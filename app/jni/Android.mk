@@ -10,7 +10,7 @@ LOCAL_MODULE    := Unknown_Xd
 # Code optimization
 LOCAL_ARM_MODE := arm
 LOCAL_CFLAGS := -Wno-error=format-security -fpermissive
-LOCAL_CFLAGS += -fno-rtti -fno-exceptions -std=c++14
+LOCAL_CFLAGS += -fno-rtti -fno-exceptions -std=c++17
 LOCAL_CPPFLAGS += -ffunction-sections -fdata-sections
 LOCAL_LDFLAGS += -Wl,--strip-all
 
@@ -24,10 +24,21 @@ LOCAL_SRC_FILES := src/Main.cpp \
                         src/UE4/PropertyFlags.cpp \
                         src/ObjectsStore.cpp \
                         src/NamesStore.cpp \
+                        src/ReflectionSnapshot.cpp \
+                        src/ClassHierarchy.cpp \
+                        src/ThreadPool.cpp \
+                        src/OutputWriter.cpp \
+                        src/Manifest.cpp \
+                        src/ArraysDump.cpp \
+                        src/SnapshotFile.cpp \
+                        src/MemoryReader.cpp \
+                        src/ModuleMap.cpp \
+                        src/PatternScanner.cpp \
                         src/Generator.cpp \
                         src/NameValidator.cpp \
                         src/UE4/GenericTypes.cpp \
                         src/PrintHelper.cpp \
+                        src/StringArena.cpp \
                         src/Package.cpp \
                        
                         
@@ -0,0 +1,528 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <ftw.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "Fixture.hpp"
+#include "Main.h"
+#include "MemoryReader.hpp"
+#include "ModuleMap.hpp"
+#include "NamesStore.hpp"
+#include "ObjectsStore.hpp"
+#include "PatternScanner.hpp"
+
+namespace
+{
+	/// <summary>The measurements of one run, written by the child process into a pipe.</summary>
+	struct Result
+	{
+		double FixtureSeconds;
+		double GenerateSeconds;
+		/// <summary>The peak resident set size after building the fixture, in kilobytes.</summary>
+		long FixtureRss;
+		uint64_t Objects;
+		uint64_t Names;
+	};
+
+	uint64_t outputBytes = 0;
+
+	int AddFileSize(const char*, const struct stat* info, int type, struct FTW*)
+	{
+		if (type == FTW_F)
+		{
+			outputBytes += info->st_size;
+		}
+		return 0;
+	}
+
+	uint64_t GetDirectorySize(const std::string& path)
+	{
+		outputBytes = 0;
+		nftw(path.c_str(), AddFileSize, 16, FTW_PHYS);
+		return outputBytes;
+	}
+
+	int RemoveFile(const char* path, const struct stat*, int, struct FTW*)
+	{
+		return remove(path);
+	}
+
+	/// <summary>Removes the output of an earlier run, its manifest would let the generator skip the unchanged packages.</summary>
+	void RemoveDirectory(const std::string& path)
+	{
+		nftw(path.c_str(), RemoveFile, 16, FTW_DEPTH | FTW_PHYS);
+	}
+
+	double SecondsSince(std::chrono::steady_clock::time_point begin)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+	}
+
+	/// <summary>Builds the fixture and runs the generator on it, in the child process.</summary>
+	int Run(const Fixture::Options& options, const std::string& outputDirectory, int fd)
+	{
+		Result result;
+		memset(&result, 0, sizeof(result));
+
+		auto begin = std::chrono::steady_clock::now();
+
+		const Fixture fixture(options);
+
+		result.FixtureSeconds = SecondsSince(begin);
+		result.Objects = fixture.GetObjectsNum();
+		result.Names = fixture.GetNamesNum();
+
+		rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+		result.FixtureRss = usage.ru_maxrss;
+
+		begin = std::chrono::steady_clock::now();
+
+		if (!NamesStore::Initialize(fixture.GetNamesAddress()) || !ObjectsStore::Initialize(fixture.GetObjectsAddress()) || !InitializeGenerator())
+		{
+			return 1;
+		}
+
+		Generate(outputDirectory);
+
+		result.GenerateSeconds = SecondsSince(begin);
+
+		return write(fd, &result, sizeof(result)) == sizeof(result) ? 0 : 1;
+	}
+
+	/// <summary>The addresses a fixture child sends to the reader benchmark.</summary>
+	struct FixtureAddresses
+	{
+		uint64_t Objects;
+		uint64_t ObjectsNum;
+	};
+
+	/// <summary>Builds the fixture and keeps it alive until the parent closes the pipe, in the child process.</summary>
+	int HoldFixture(const Fixture::Options& options, int addressFd, int releaseFd)
+	{
+		const Fixture fixture(options);
+
+		const FixtureAddresses addresses = { reinterpret_cast<uintptr_t>(fixture.GetObjectsAddress()), fixture.GetObjectsNum() };
+		if (write(addressFd, &addresses, sizeof(addresses)) != sizeof(addresses))
+		{
+			return 1;
+		}
+
+		char released;
+		return read(releaseFd, &released, 1) < 0 ? 1 : 0;
+	}
+
+	/// <summary>
+	/// Reads the object headers and the super chains of the classes of a fixture child with one call per read,
+	/// with batched reads and through the page cache.
+	/// </summary>
+	bool RunReader(pid_t pid, const FixtureAddresses& addresses)
+	{
+		MemoryReader reader(pid);
+
+		FUObjectArray objectArray;
+		if (!reader.ReadCached(addresses.Objects, &objectArray, sizeof(objectArray)))
+		{
+			return false;
+		}
+
+		std::vector<FUObjectItem> items(objectArray.ObjObjects.NumElements);
+		reader.Queue(reinterpret_cast<uintptr_t>(objectArray.ObjObjects.Objects), items.data(), items.size() * sizeof(FUObjectItem));
+		if (reader.Flush() != 0)
+		{
+			return false;
+		}
+
+		std::vector<UObject> headers(items.size());
+		const auto validate = [&]()
+		{
+			for (auto i = 0u; i < headers.size(); ++i)
+			{
+				if (headers[i].InternalIndex != static_cast<int32_t>(i))
+				{
+					return false;
+				}
+			}
+			return true;
+		};
+
+		//one call per object
+		auto begin = std::chrono::steady_clock::now();
+		auto calls = reader.GetStats().Calls;
+		for (auto i = 0u; i < items.size(); ++i)
+		{
+			reader.Queue(reinterpret_cast<uintptr_t>(items[i].Object), &headers[i], sizeof(UObject));
+			reader.Flush();
+		}
+		const auto singleSeconds = SecondsSince(begin);
+		const auto singleCalls = reader.GetStats().Calls - calls;
+		if (!validate())
+		{
+			return false;
+		}
+
+		//one batch
+		memset(headers.data(), 0, headers.size() * sizeof(UObject));
+		begin = std::chrono::steady_clock::now();
+		calls = reader.GetStats().Calls;
+		for (auto i = 0u; i < items.size(); ++i)
+		{
+			reader.Queue(reinterpret_cast<uintptr_t>(items[i].Object), &headers[i], sizeof(UObject));
+		}
+		if (reader.Flush() != 0)
+		{
+			return false;
+		}
+		const auto batchSeconds = SecondsSince(begin);
+		const auto batchCalls = reader.GetStats().Calls - calls;
+		if (!validate())
+		{
+			return false;
+		}
+
+		//the super chains of the classes hit the same few class objects
+		begin = std::chrono::steady_clock::now();
+		calls = reader.GetStats().Calls;
+		for (auto&& header : headers)
+		{
+			for (auto cls = reinterpret_cast<uintptr_t>(header.ClassPrivate); cls != 0; )
+			{
+				UStruct structObj;
+				if (!reader.ReadCached(cls, &structObj, sizeof(structObj)))
+				{
+					return false;
+				}
+				cls = reinterpret_cast<uintptr_t>(structObj.SuperStruct);
+			}
+		}
+		const auto cachedSeconds = SecondsSince(begin);
+		const auto cachedCalls = reader.GetStats().Calls - calls;
+
+		printf("%10llu %10.3f %10zu %10.3f %10zu %10.3f %10zu %10zu %10zu\n",
+			static_cast<unsigned long long>(addresses.ObjectsNum), singleSeconds, singleCalls, batchSeconds, batchCalls,
+			cachedSeconds, cachedCalls, reader.GetStats().CacheHits, reader.GetStats().CacheMisses);
+		fflush(stdout);
+
+		return true;
+	}
+
+	int RunReaderBenchmark(Fixture::Options options, const std::vector<size_t>& sizes)
+	{
+		printf("%10s %10s %10s %10s %10s %10s %10s %10s %10s\n", "objects", "single s", "calls", "batch s", "calls", "cached s", "calls", "hits", "misses");
+
+		for (auto size : sizes)
+		{
+			options.Objects = size;
+
+			int addressFds[2];
+			int releaseFds[2];
+			if (pipe(addressFds) != 0 || pipe(releaseFds) != 0)
+			{
+				perror("pipe");
+				return 1;
+			}
+
+			const auto pid = fork();
+			if (pid < 0)
+			{
+				perror("fork");
+				return 1;
+			}
+			if (pid == 0)
+			{
+				close(addressFds[0]);
+				close(releaseFds[1]);
+				_exit(HoldFixture(options, addressFds[1], releaseFds[0]));
+			}
+			close(addressFds[1]);
+			close(releaseFds[0]);
+
+			FixtureAddresses addresses;
+			const auto success = read(addressFds[0], &addresses, sizeof(addresses)) == sizeof(addresses) && RunReader(pid, addresses);
+
+			close(addressFds[0]);
+			close(releaseFds[1]);
+			waitpid(pid, nullptr, 0);
+
+			if (!success)
+			{
+				fprintf(stderr, "The reader run with %zu objects failed\n", size);
+				return 1;
+			}
+		}
+
+		return 0;
+	}
+
+	/// <summary>Checks every position with the whole pattern, the reference for the scanner.</summary>
+	const uint8_t* FindNaive(const uint8_t* begin, const uint8_t* end, const BytePattern& pattern)
+	{
+		for (auto it = begin; it + pattern.Bytes.size() <= end; ++it)
+		{
+			auto matches = true;
+			for (auto i = 0u; i < pattern.Bytes.size() && matches; ++i)
+			{
+				matches = (it[i] & pattern.Mask[i]) == pattern.Bytes[i];
+			}
+			if (matches)
+			{
+				return it;
+			}
+		}
+		return nullptr;
+	}
+
+	void WriteInstruction(uint8_t* address, uint32_t instruction)
+	{
+		memcpy(address, &instruction, sizeof(instruction));
+	}
+
+	/// <summary>ADRP Xd, page of the target; ADD Xd, Xd, #offset in page; MOV X0, Xd; RET</summary>
+	void WriteAdrpAdd(uint8_t* address, uintptr_t target, uint32_t rd)
+	{
+		const auto pages = static_cast<uint64_t>((target >> 12) - (reinterpret_cast<uintptr_t>(address) >> 12));
+		WriteInstruction(address, 0x90000000 | (pages & 0x3) << 29 | (pages >> 2 & 0x7FFFF) << 5 | rd);
+		WriteInstruction(address + 4, 0x91000000 | (target & 0xFFF) << 10 | rd << 5 | rd);
+		WriteInstruction(address + 8, 0xAA0003E0 | rd << 16);
+		WriteInstruction(address + 12, 0xD65F03C0);
+	}
+
+	/// <summary>MOV RAX, [RIP + disp32 of the target]; TEST RAX, RAX; JE</summary>
+	void WriteRipRelative(uint8_t* address, uintptr_t target)
+	{
+		const uint8_t code[] = { 0x48, 0x8B, 0x05, 0, 0, 0, 0, 0x48, 0x85, 0xC0, 0x74, 0x10 };
+		memcpy(address, code, sizeof(code));
+		const auto displacement = static_cast<int32_t>(target - (reinterpret_cast<uintptr_t>(address) + 7));
+		memcpy(address + 3, &displacement, sizeof(displacement));
+	}
+
+	/// <summary>Scans a buffer for a signature planted near its end with the scanner and the naive reference.</summary>
+	bool ScanBuffer(const char* name, const std::vector<uint8_t>& buffer, const Signature& signature, const uint8_t* planted, uintptr_t expected)
+	{
+		BytePattern pattern;
+		if (!PatternScanner::Parse(signature.Pattern, pattern))
+		{
+			return false;
+		}
+
+		const auto begin = buffer.data();
+		const auto end = begin + buffer.size();
+
+		auto start = std::chrono::steady_clock::now();
+		const auto match = PatternScanner::Find(begin, end, pattern);
+		const auto scannerSeconds = SecondsSince(start);
+
+		start = std::chrono::steady_clock::now();
+		const auto reference = FindNaive(begin, end, pattern);
+		const auto naiveSeconds = SecondsSince(start);
+
+		const auto address = match != nullptr ? PatternScanner::Decode(match, end, signature) : 0;
+		const auto megabytes = buffer.size() / (1024.0 * 1024.0);
+		printf("%-14s %10.1f %12.1f %10.1f %12.1f  %s\n", name, scannerSeconds * 1000, megabytes / scannerSeconds,
+			naiveSeconds * 1000, megabytes / naiveSeconds, match == planted && reference == planted && address == expected ? "ok" : "FAILED");
+
+		return match == planted && reference == planted && address == expected;
+	}
+
+	/// <summary>
+	/// Measures the pattern scanner on a buffer of random bytes with an arm64 and an x86 signature planted near the end,
+	/// and resolves a signature made from the code of the scanner in the mapping of this executable.
+	/// </summary>
+	int RunScannerBenchmark(size_t megabytes)
+	{
+		printf("implementation: %s\n", PatternScanner::GetImplementationName());
+		printf("%-14s %10s %12s %10s %12s\n", "signature", "scan ms", "MB/s", "naive ms", "MB/s");
+
+		std::vector<uint8_t> buffer(megabytes * 1024 * 1024);
+		uint64_t state = 0x9E3779B97F4A7C15ull;
+		for (auto i = 0u; i + 8 <= buffer.size(); i += 8)
+		{
+			state ^= state << 13;
+			state ^= state >> 7;
+			state ^= state << 17;
+			memcpy(buffer.data() + i, &state, sizeof(state));
+		}
+
+		auto success = true;
+
+		const auto adrp = buffer.data() + buffer.size() - 4096;
+		const auto adrpTarget = reinterpret_cast<uintptr_t>(buffer.data()) + 0x1234;
+		WriteAdrpAdd(adrp, adrpTarget, 8);
+		success &= ScanBuffer("Adrp", buffer, { "GUObjectArray", Signature::Kind::Adrp, "?8 ?? ?? ?0 08 ?? ?? 91 E0 03 08 AA C0 03 5F D6", 0 }, adrp, adrpTarget);
+
+		const auto rip = buffer.data() + buffer.size() - 2048;
+		const auto ripTarget = reinterpret_cast<uintptr_t>(buffer.data()) + 0x5678;
+		WriteRipRelative(rip, ripTarget);
+		success &= ScanBuffer("RipRelative", buffer, { "GUObjectArray", Signature::Kind::RipRelative, "48 8B 05 ?? ?? ?? ?? 48 85 C0 74 ??", 0 }, rip, ripTarget);
+
+		//a real ELF mapping, the code of the scanner should be found where the linker put it
+		char path[PATH_MAX];
+		const auto length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+		ModuleMap::Module module;
+		if (length <= 0 || !ModuleMap::GetModule(std::string(path, length).substr(std::string(path, length).rfind('/') + 1), module))
+		{
+			fprintf(stderr, "The module of the executable is not mapped\n");
+			return 1;
+		}
+
+		const auto code = reinterpret_cast<const uint8_t*>(&PatternScanner::Decode);
+		std::string text;
+		for (auto i = 0; i < 32; ++i)
+		{
+			char hex[4];
+			snprintf(hex, sizeof(hex), i == 0 ? "%02X" : " %02X", code[i]);
+			text += hex;
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		const auto address = PatternScanner::Resolve(module, { "Decode", Signature::Kind::Match, text, 0 });
+		const auto seconds = SecondsSince(start);
+		printf("%-14s %10.1f %12.1f %10s %12s  %s (%s, %.1f MB)\n", "ELF", seconds * 1000, (module.End - module.Begin) / (1024.0 * 1024.0) / seconds,
+			"-", "-", address == reinterpret_cast<uintptr_t>(code) ? "ok" : "FAILED", module.Name.c_str(), (module.End - module.Begin) / (1024.0 * 1024.0));
+		success &= address == reinterpret_cast<uintptr_t>(code);
+
+		return success ? 0 : 1;
+	}
+
+	void PrintUsage(const char* name)
+	{
+		fprintf(stderr, "Usage: %s [-r | -x megabytes] [-i] [-o output directory] [-p packages] [-s properties per struct] [-d inheritance depth] [objects...]\n", name);
+		fprintf(stderr, "  -i  keeps the output of the last run, the generation only rewrites the changed packages\n");
+		fprintf(stderr, "  -r  reads the fixture of a child process with MemoryReader instead of generating the SDK\n");
+		fprintf(stderr, "  -x  scans a buffer of the size and the executable with PatternScanner instead of generating the SDK\n");
+	}
+}
+
+/// <summary>
+/// Runs the whole generation (names and objects initialization, dumps, packages and the SDK header) against synthetic
+/// object graphs and reports the wall time, the peak resident set size and the size of the output.
+/// Every size runs in its own process so the peak resident set sizes do not influence each other.
+/// The output of every size is removed before its run unless -i measures the incremental generation.
+/// With -r it measures MemoryReader against the fixture of a child process instead, with -x the PatternScanner.
+/// </summary>
+int main(int argc, char** argv)
+{
+	Fixture::Options options;
+	std::string outputDirectory = "benchmark-output";
+	auto reader = false;
+	auto incremental = false;
+	size_t scannerMegabytes = 0;
+
+	int option;
+	while ((option = getopt(argc, argv, "rix:o:p:s:d:h")) != -1)
+	{
+		switch (option)
+		{
+		case 'r':
+			reader = true;
+			break;
+		case 'i':
+			incremental = true;
+			break;
+		case 'x':
+			scannerMegabytes = strtoul(optarg, nullptr, 10);
+			break;
+		case 'o':
+			outputDirectory = optarg;
+			break;
+		case 'p':
+			options.Packages = strtoul(optarg, nullptr, 10);
+			break;
+		case 's':
+			options.PropertiesPerStruct = strtoul(optarg, nullptr, 10);
+			break;
+		case 'd':
+			options.InheritanceDepth = strtoul(optarg, nullptr, 10);
+			break;
+		default:
+			PrintUsage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (scannerMegabytes != 0)
+	{
+		return RunScannerBenchmark(scannerMegabytes);
+	}
+
+	std::vector<size_t> sizes;
+	for (auto i = optind; i < argc; ++i)
+	{
+		sizes.push_back(strtoul(argv[i], nullptr, 10));
+	}
+	if (sizes.empty())
+	{
+		sizes = { 10000, 100000, 1000000 };
+	}
+
+	if (reader)
+	{
+		return RunReaderBenchmark(options, sizes);
+	}
+
+	mkdir(outputDirectory.c_str(), 0777);
+
+	printf("%10s %10s %10s %12s %13s %13s %14s  %s\n", "objects", "names", "fixture s", "generate s", "fixture RSS", "peak RSS", "output bytes", "output");
+
+	for (auto size : sizes)
+	{
+		options.Objects = size;
+
+		const auto path = outputDirectory + "/" + std::to_string(size);
+		if (!incremental)
+		{
+			RemoveDirectory(path);
+		}
+
+		int fds[2];
+		if (pipe(fds) != 0)
+		{
+			perror("pipe");
+			return 1;
+		}
+
+		const auto pid = fork();
+		if (pid < 0)
+		{
+			perror("fork");
+			return 1;
+		}
+		if (pid == 0)
+		{
+			close(fds[0]);
+			_exit(Run(options, path, fds[1]));
+		}
+		close(fds[1]);
+
+		Result result;
+		const auto received = read(fds[0], &result, sizeof(result));
+		close(fds[0]);
+
+		int status;
+		rusage usage;
+		wait4(pid, &status, 0, &usage);
+
+		if (received != sizeof(result) || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+		{
+			fprintf(stderr, "The run with %zu objects failed, see %s/Unknown.log\n", size, path.c_str());
+			return 1;
+		}
+
+		printf("%10llu %10llu %10.2f %12.2f %10ld KB %10ld KB %14llu  %s\n",
+			static_cast<unsigned long long>(result.Objects), static_cast<unsigned long long>(result.Names),
+			result.FixtureSeconds, result.GenerateSeconds, result.FixtureRss, usage.ru_maxrss,
+			static_cast<unsigned long long>(GetDirectorySize(path)), path.c_str());
+		fflush(stdout);
+	}
+
+	return 0;
+}
@@ -0,0 +1,459 @@
+#include "Fixture.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "tinyformat.h"
+
+namespace
+{
+	/// <summary>The size of the memory blocks the objects and names are carved from.</summary>
+	constexpr size_t BlockSize = 1024 * 1024;
+
+	constexpr size_t Alignment = 16;
+
+	constexpr int32_t CPF_Parm = 0x80;
+	constexpr int32_t CPF_ReturnParm = 0x400;
+
+	constexpr int32_t FUNC_Public = 0x20000;
+	constexpr int32_t FUNC_Native = 0x400;
+
+	/// <summary>The number of values of every enum, including the _MAX value.</summary>
+	constexpr size_t EnumValuesNum = 5;
+
+	/// <summary>A script struct is added to a package for every StructInterval classes.</summary>
+	constexpr size_t StructInterval = 4;
+
+	/// <summary>Mirrors the private members of TArray to fill the names of the enums.</summary>
+	struct EnumNamesLayout
+	{
+		TPair<FName, uint64_t>* Data;
+		int32_t Count;
+		int32_t Max;
+	};
+	static_assert(sizeof(EnumNamesLayout) == sizeof(TArray<TPair<FName, uint64_t>>), "TArray layout changed");
+
+	/// <summary>The kinds of properties the structs and classes cycle through.</summary>
+	enum class PropertyKind
+	{
+		Int,
+		Float,
+		Bool,
+		Byte,
+		Name,
+		Str,
+		Object,
+		Struct,
+		Array,
+		Enum,
+		Count
+	};
+
+	struct CoreClassInfo
+	{
+		const char* Name;
+		const char* Super;
+		size_t Size;
+	};
+
+	const CoreClassInfo CoreClasses[] =
+	{
+		{ "Object", "", sizeof(UObject) },
+		{ "Field", "Object", sizeof(UField) },
+		{ "Struct", "Field", sizeof(UStruct) },
+		{ "Class", "Struct", sizeof(UClass) },
+		{ "ScriptStruct", "Struct", sizeof(UScriptStruct) },
+		{ "Function", "Struct", sizeof(UFunction) },
+		{ "Enum", "Field", sizeof(UEnum) },
+		{ "Package", "Object", sizeof(UObject) },
+		{ "Property", "Field", sizeof(UProperty) },
+		{ "NumericProperty", "Property", sizeof(UNumericProperty) },
+		{ "ByteProperty", "NumericProperty", sizeof(UByteProperty) },
+		{ "UInt16Property", "NumericProperty", sizeof(UUInt16Property) },
+		{ "UInt32Property", "NumericProperty", sizeof(UUInt32Property) },
+		{ "UInt64Property", "NumericProperty", sizeof(UUInt64Property) },
+		{ "Int8Property", "NumericProperty", sizeof(UInt8Property) },
+		{ "Int16Property", "NumericProperty", sizeof(UInt16Property) },
+		{ "IntProperty", "NumericProperty", sizeof(UIntProperty) },
+		{ "Int64Property", "NumericProperty", sizeof(UInt64Property) },
+		{ "FloatProperty", "NumericProperty", sizeof(UFloatProperty) },
+		{ "DoubleProperty", "NumericProperty", sizeof(UDoubleProperty) },
+		{ "BoolProperty", "Property", sizeof(UBoolProperty) },
+		{ "ObjectPropertyBase", "Property", sizeof(UObjectPropertyBase) },
+		{ "ObjectProperty", "ObjectPropertyBase", sizeof(UObjectProperty) },
+		{ "ClassProperty", "ObjectProperty", sizeof(UClassProperty) },
+		{ "InterfaceProperty", "Property", sizeof(UInterfaceProperty) },
+		{ "WeakObjectProperty", "ObjectPropertyBase", sizeof(UWeakObjectProperty) },
+		{ "LazyObjectProperty", "ObjectPropertyBase", sizeof(ULazyObjectProperty) },
+		{ "AssetObjectProperty", "ObjectPropertyBase", sizeof(UAssetObjectProperty) },
+		{ "AssetClassProperty", "AssetObjectProperty", sizeof(UAssetClassProperty) },
+		{ "NameProperty", "Property", sizeof(UNameProperty) },
+		{ "StructProperty", "Property", sizeof(UStructProperty) },
+		{ "StrProperty", "Property", sizeof(UStrProperty) },
+		{ "TextProperty", "Property", sizeof(UTextProperty) },
+		{ "ArrayProperty", "Property", sizeof(UArrayProperty) },
+		{ "MapProperty", "Property", sizeof(UMapProperty) },
+		{ "DelegateProperty", "Property", sizeof(UDelegateProperty) },
+		{ "MulticastDelegateProperty", "Property", sizeof(UMulticastDelegateProperty) },
+		{ "EnumProperty", "Property", sizeof(UEnumProperty) }
+	};
+
+	int32_t AlignOffset(int32_t offset, int32_t alignment)
+	{
+		return (offset + alignment - 1) / alignment * alignment;
+	}
+
+	void AddChild(UStruct* owner, UField* child)
+	{
+		auto next = &owner->Children;
+		while (*next != nullptr)
+		{
+			next = &(*next)->Next;
+		}
+		*next = child;
+	}
+}
+
+Fixture::Fixture(const Options& _options)
+	: options(_options)
+{
+	options.Packages = std::max<size_t>(options.Packages, 1);
+	options.InheritanceDepth = std::max<size_t>(options.InheritanceDepth, 1);
+
+	names = static_cast<TNameEntryArray*>(Allocate(sizeof(TNameEntryArray)));
+	objectArray = static_cast<FUObjectArray*>(Allocate(sizeof(FUObjectArray)));
+
+	corePackage = AddObject<UObject>(nullptr, nullptr, "/Script/CoreUObject");
+	for (auto&& info : CoreClasses)
+	{
+		AddCoreClass(info.Name, info.Super, info.Size);
+	}
+
+	//the core classes are instances of Class
+	const auto classClass = coreClasses["Class"];
+	for (auto&& cls : coreClasses)
+	{
+		cls.second->ClassPrivate = classClass;
+	}
+	corePackage->ClassPrivate = coreClasses["Package"];
+
+	std::vector<PackageState> packages(options.Packages);
+	for (auto i = 0u; i < packages.size(); ++i)
+	{
+		packages[i].Name = tfm::format("Module%d", i);
+		packages[i].Package = AddObject<UObject>(coreClasses["Package"], nullptr, "/Script/" + packages[i].Name);
+	}
+
+	//the packages grow round robin, every package depends on the previous one
+	while (objects.size() < options.Objects)
+	{
+		for (auto i = 0u; i < packages.size() && objects.size() < options.Objects; ++i)
+		{
+			auto& package = packages[i];
+			if (package.Enum == nullptr)
+			{
+				AddEnum(package);
+			}
+			if (package.Classes % StructInterval == 0)
+			{
+				AddStruct(package);
+			}
+
+			const auto dependency = i > 0 && packages[i - 1].Class != nullptr ? &packages[i - 1] : nullptr;
+			AddClass(package, dependency);
+		}
+	}
+
+	Finish();
+}
+
+void* Fixture::GetNamesAddress() const
+{
+	return names;
+}
+
+void* Fixture::GetObjectsAddress() const
+{
+	return objectArray;
+}
+
+size_t Fixture::GetObjectsNum() const
+{
+	return objects.size();
+}
+
+size_t Fixture::GetNamesNum() const
+{
+	return nameIds.size();
+}
+
+void* Fixture::Allocate(size_t size)
+{
+	size = (size + Alignment - 1) / Alignment * Alignment;
+
+	if (size > BlockSize / 4)
+	{
+		//large arrays get their own block, the current block stays in use
+		blocks.push_back(std::make_unique<char[]>(size));
+		return blocks.back().get();
+	}
+
+	if (block == nullptr || blockUsed + size > BlockSize)
+	{
+		blocks.push_back(std::make_unique<char[]>(BlockSize));
+		block = blocks.back().get();
+		blockUsed = 0;
+	}
+
+	const auto memory = block + blockUsed;
+	blockUsed += size;
+	return memory;
+}
+
+int32_t Fixture::AddName(const std::string& name)
+{
+	const auto it = nameIds.find(name);
+	if (it != std::end(nameIds))
+	{
+		return it->second;
+	}
+
+	const auto id = names->NumElements++;
+	const auto chunk = id / TNameEntryArray::GetElementsPerChunk();
+	if (names->Chunks[chunk] == nullptr)
+	{
+		names->Chunks[chunk] = static_cast<FNameEntry**>(Allocate(TNameEntryArray::GetElementsPerChunk() * sizeof(FNameEntry*)));
+		++names->NumChunks;
+	}
+
+	//only the used part of the name buffer is allocated
+	const auto entry = static_cast<FNameEntry*>(Allocate(offsetof(FNameEntry, AnsiName) + name.length() + 1));
+	entry->Index = id << 1;
+	std::memcpy(entry->AnsiName, name.c_str(), name.length() + 1);
+
+	names->Chunks[chunk][id % TNameEntryArray::GetElementsPerChunk()] = entry;
+	nameIds.emplace(name, id);
+
+	return id;
+}
+
+template<typename T>
+T* Fixture::AddObject(UClass* cls, UObject* outer, const std::string& name)
+{
+	const auto object = static_cast<T*>(Allocate(sizeof(T)));
+	object->InternalIndex = static_cast<int32_t>(objects.size());
+	object->ClassPrivate = cls;
+	object->OuterPrivate = outer;
+	object->NamePrivate.ComparisonIndex = AddName(name);
+
+	objects.push_back(object);
+
+	return object;
+}
+
+UClass* Fixture::AddCoreClass(const std::string& name, const std::string& super, size_t size)
+{
+	const auto cls = AddObject<UClass>(nullptr, corePackage, name);
+	cls->PropertySize = static_cast<int32_t>(size);
+	cls->MinAlignment = sizeof(void*);
+	if (!super.empty())
+	{
+		cls->SuperStruct = coreClasses[super];
+	}
+
+	coreClasses[name] = cls;
+
+	return cls;
+}
+
+UProperty* Fixture::AddProperty(UStruct* owner, size_t kind, const std::string& name, int32_t& offset, const PackageState& package, const PackageState* dependency)
+{
+	UProperty* property = nullptr;
+	int32_t size = 0;
+
+	switch (static_cast<PropertyKind>(kind % static_cast<size_t>(PropertyKind::Count)))
+	{
+	case PropertyKind::Int:
+		property = AddObject<UIntProperty>(coreClasses["IntProperty"], owner, name);
+		size = sizeof(int32_t);
+		break;
+	case PropertyKind::Float:
+		property = AddObject<UFloatProperty>(coreClasses["FloatProperty"], owner, name);
+		size = sizeof(float);
+		break;
+	case PropertyKind::Bool:
+	{
+		const auto boolProperty = AddObject<UBoolProperty>(coreClasses["BoolProperty"], owner, name);
+		boolProperty->FieldSize = 1;
+		boolProperty->ByteMask = 0xFF;
+		boolProperty->FieldMask = 0xFF;
+		property = boolProperty;
+		size = sizeof(bool);
+		break;
+	}
+	case PropertyKind::Byte:
+	{
+		const auto byteProperty = AddObject<UByteProperty>(coreClasses["ByteProperty"], owner, name);
+		byteProperty->Enum = package.Enum;
+		property = byteProperty;
+		size = sizeof(uint8_t);
+		break;
+	}
+	case PropertyKind::Name:
+		property = AddObject<UNameProperty>(coreClasses["NameProperty"], owner, name);
+		size = sizeof(FName);
+		break;
+	case PropertyKind::Str:
+		property = AddObject<UStrProperty>(coreClasses["StrProperty"], owner, name);
+		size = sizeof(FString);
+		break;
+	case PropertyKind::Object:
+	{
+		const auto objectProperty = AddObject<UObjectProperty>(coreClasses["ObjectProperty"], owner, name);
+		objectProperty->PropertyClass = dependency != nullptr ? dependency->Class : coreClasses["Object"];
+		property = objectProperty;
+		size = sizeof(void*);
+		break;
+	}
+	case PropertyKind::Struct:
+	{
+		//the first struct of a package has no struct to nest
+		if (package.Struct == nullptr)
+		{
+			return AddProperty(owner, static_cast<size_t>(PropertyKind::Int), name, offset, package, dependency);
+		}
+		const auto structProperty = AddObject<UStructProperty>(coreClasses["StructProperty"], owner, name);
+		structProperty->Struct = package.Struct;
+		property = structProperty;
+		size = package.Struct->PropertySize;
+		break;
+	}
+	case PropertyKind::Array:
+	{
+		const auto arrayProperty = AddObject<UArrayProperty>(coreClasses["ArrayProperty"], owner, name);
+		const auto inner = AddObject<UIntProperty>(coreClasses["IntProperty"], arrayProperty, name);
+		inner->ArrayDim = 1;
+		inner->ElementSize = sizeof(int32_t);
+		arrayProperty->Inner = inner;
+		property = arrayProperty;
+		size = sizeof(TArray<void*>);
+		break;
+	}
+	case PropertyKind::Enum:
+	{
+		const auto enumProperty = AddObject<UEnumProperty>(coreClasses["EnumProperty"], owner, name);
+		enumProperty->Enum = package.Enum;
+		property = enumProperty;
+		size = sizeof(uint8_t);
+		break;
+	}
+	default:
+		return nullptr;
+	}
+
+	offset = AlignOffset(offset, std::min<int32_t>(size, sizeof(void*)));
+
+	property->ArrayDim = 1;
+	property->ElementSize = size;
+	property->Offset = offset;
+
+	offset += size;
+
+	AddChild(owner, property);
+
+	return property;
+}
+
+void Fixture::AddEnum(PackageState& package)
+{
+	const auto name = "E" + package.Name + "Type";
+
+	package.Enum = AddObject<UEnum>(coreClasses["Enum"], package.Package, name);
+
+	const auto values = static_cast<TPair<FName, uint64_t>*>(Allocate(EnumValuesNum * sizeof(TPair<FName, uint64_t>)));
+	for (auto i = 0u; i < EnumValuesNum; ++i)
+	{
+		const auto value = i + 1 < EnumValuesNum ? tfm::format("Value%d", i) : name + "_MAX";
+		values[i].Key.ComparisonIndex = AddName(name + "::" + value);
+		values[i].Value = i;
+	}
+
+	auto& layout = reinterpret_cast<EnumNamesLayout&>(package.Enum->Names);
+	layout.Data = values;
+	layout.Count = layout.Max = EnumValuesNum;
+}
+
+void Fixture::AddStruct(PackageState& package)
+{
+	const auto name = tfm::format("%sStruct%d", package.Name, package.Structs++);
+
+	const auto scriptStruct = AddObject<UScriptStruct>(coreClasses["ScriptStruct"], package.Package, name);
+	scriptStruct->MinAlignment = sizeof(void*);
+
+	int32_t offset = 0;
+	for (auto i = 0u; i < options.PropertiesPerStruct; ++i)
+	{
+		//structs only nest the previous struct of their package
+		AddProperty(scriptStruct, i, tfm::format("Field%d", i), offset, package, nullptr);
+	}
+	scriptStruct->PropertySize = std::max(AlignOffset(offset, sizeof(void*)), 1);
+
+	package.Struct = scriptStruct;
+}
+
+void Fixture::AddClass(PackageState& package, const PackageState* dependency)
+{
+	const auto name = tfm::format("%sActor%d", package.Name, package.Classes++);
+
+	//the classes of a package form chains of InheritanceDepth classes
+	UClass* super = coreClasses["Object"];
+	if (package.Class != nullptr && package.ChainLength < options.InheritanceDepth)
+	{
+		super = package.Class;
+		++package.ChainLength;
+	}
+	else
+	{
+		package.ChainLength = 1;
+	}
+
+	const auto cls = AddObject<UClass>(coreClasses["Class"], package.Package, name);
+	cls->SuperStruct = super;
+	cls->MinAlignment = sizeof(void*);
+
+	auto offset = super->PropertySize;
+	for (auto i = 0u; i < options.PropertiesPerStruct; ++i)
+	{
+		AddProperty(cls, i, tfm::format("Value%d", i), offset, package, dependency);
+	}
+	cls->PropertySize = AlignOffset(offset, sizeof(void*));
+
+	//every class has a native function with a parameter and a return value
+	const auto function = AddObject<UFunction>(coreClasses["Function"], cls, "Update");
+	function->FunctionFlags = FUNC_Native | FUNC_Public;
+
+	int32_t parameterOffset = 0;
+	AddProperty(function, static_cast<size_t>(PropertyKind::Object), "Target", parameterOffset, package, dependency)->PropertyFlags.A = CPF_Parm;
+	AddProperty(function, static_cast<size_t>(PropertyKind::Int), "ReturnValue", parameterOffset, package, dependency)->PropertyFlags.A = CPF_Parm | CPF_ReturnParm;
+	function->PropertySize = AlignOffset(parameterOffset, sizeof(void*));
+	function->NumParms = 2;
+	function->ParmsSize = static_cast<int16_t>(function->PropertySize);
+
+	AddChild(cls, function);
+
+	package.Class = cls;
+}
+
+void Fixture::Finish()
+{
+	const auto items = static_cast<FUObjectItem*>(Allocate(objects.size() * sizeof(FUObjectItem)));
+	for (auto i = 0u; i < objects.size(); ++i)
+	{
+		items[i].Object = objects[i];
+		items[i].SerialNumber = static_cast<int32_t>(i + 1);
+	}
+
+	objectArray->ObjObjects.Objects = items;
+	objectArray->ObjObjects.MaxElements = static_cast<int32_t>(objects.size());
+	objectArray->ObjObjects.NumElements = static_cast<int32_t>(objects.size());
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ObjectsStore.hpp"
+#include "EngineClasses.hpp"
+
+/// <summary>
+/// A synthetic UE4 object graph laid out in memory like the engine classes of EngineClasses.hpp:
+/// a TNameEntryArray, a FUObjectArray, the CoreUObject classes and packages with enums, script structs and class chains.
+/// The generator reads it through NamesStore::Initialize(void*) and ObjectsStore::Initialize(void*) like the memory of a game.
+/// </summary>
+class Fixture
+{
+public:
+	struct Options
+	{
+		/// <summary>The number of objects to create, the fixture stops after the first unit which reaches it.</summary>
+		size_t Objects = 10000;
+		/// <summary>The number of packages the structs and classes are spread over.</summary>
+		size_t Packages = 100;
+		/// <summary>The number of properties of every struct and class.</summary>
+		size_t PropertiesPerStruct = 8;
+		/// <summary>The length of the class chains, 1 derives every class from Object.</summary>
+		size_t InheritanceDepth = 4;
+	};
+
+	explicit Fixture(const Options& options);
+
+	Fixture(const Fixture&) = delete;
+	Fixture& operator=(const Fixture&) = delete;
+
+	/// <summary>The address of the TNameEntryArray.</summary>
+	void* GetNamesAddress() const;
+
+	/// <summary>The address of the FUObjectArray.</summary>
+	void* GetObjectsAddress() const;
+
+	size_t GetObjectsNum() const;
+
+	size_t GetNamesNum() const;
+
+private:
+	/// <summary>The last created objects of a package.</summary>
+	struct PackageState
+	{
+		/// <summary>The short name of the package, the prefix of the names of its objects.</summary>
+		std::string Name;
+		UObject* Package = nullptr;
+		UEnum* Enum = nullptr;
+		UScriptStruct* Struct = nullptr;
+		UClass* Class = nullptr;
+		size_t ChainLength = 0;
+		size_t Classes = 0;
+		size_t Structs = 0;
+	};
+
+	/// <summary>Allocates zeroed memory which lives as long as the fixture.</summary>
+	void* Allocate(size_t size);
+
+	int32_t AddName(const std::string& name);
+
+	template<typename T>
+	T* AddObject(UClass* cls, UObject* outer, const std::string& name);
+
+	UClass* AddCoreClass(const std::string& name, const std::string& super, size_t size);
+
+	UProperty* AddProperty(UStruct* owner, size_t kind, const std::string& name, int32_t& offset, const PackageState& package, const PackageState* dependency);
+
+	void AddEnum(PackageState& package);
+
+	void AddStruct(PackageState& package);
+
+	void AddClass(PackageState& package, const PackageState* dependency);
+
+	void Finish();
+
+	Options options;
+
+	std::vector<std::unique_ptr<char[]>> blocks;
+	char* block = nullptr;
+	size_t blockUsed = 0;
+
+	std::unordered_map<std::string, int32_t> nameIds;
+	std::vector<UObject*> objects;
+
+	std::unordered_map<std::string, UClass*> coreClasses;
+	UObject* corePackage = nullptr;
+
+	TNameEntryArray* names = nullptr;
+	FUObjectArray* objectArray = nullptr;
+};
@@ -0,0 +1,176 @@
+#include "ArraysDump.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include "tinyformat.h"
+#include "NamesStore.hpp"
+#include "ObjectsStore.hpp"
+#include "EngineClasses.hpp"
+#include "ReflectionSnapshot.hpp"
+#include "OutputWriter.hpp"
+#include "ThreadPool.hpp"
+
+constexpr const char* ArraysDump::FileName;
+constexpr uint32_t ArraysDump::Magic;
+constexpr uint32_t ArraysDump::Version;
+
+namespace
+{
+	/// <summary>The number of entries rendered by one task of the text dump.</summary>
+	constexpr size_t TextChunkSize = 16384;
+
+	int32_t GetObjectIndex(const UEObject& obj)
+	{
+		return obj.IsValid() ? static_cast<int32_t>(obj.GetIndex()) : -1;
+	}
+
+	void Append(std::string& buffer, const void* data, size_t size)
+	{
+		buffer.append(static_cast<const char*>(data), size);
+	}
+
+	/// <summary>
+	/// Renders the entries [0, count) with the format function in parallel chunks and writes the chunks in order.
+	/// </summary>
+	template<typename Fn>
+	void WriteChunked(std::ostream& os, size_t count, Fn&& format)
+	{
+		const auto chunks = (count + TextChunkSize - 1) / TextChunkSize;
+
+		std::vector<std::string> rendered(chunks);
+
+		ThreadPool pool;
+		pool.Run(chunks, [&](size_t chunk)
+		{
+			std::ostringstream ss;
+
+			const auto end = std::min(count, (chunk + 1) * TextChunkSize);
+			for (auto i = chunk * TextChunkSize; i < end; ++i)
+			{
+				format(ss, i);
+			}
+
+			rendered[chunk] = ss.str();
+		});
+
+		for (auto&& chunk : rendered)
+		{
+			os << chunk;
+
+			std::string().swap(chunk);
+		}
+	}
+}
+
+void ArraysDump::WriteBinary(const std::string& path)
+{
+	const NamesStore names;
+	const ObjectsStore objects;
+	const ReflectionSnapshot snapshot;
+
+	const auto namesNum = names.GetNamesNum();
+	const auto objectsNum = objects.GetObjectsNum();
+
+	std::vector<ObjectRecord> records(objectsNum);
+	for (auto i = 0u; i < objectsNum; ++i)
+	{
+		auto& record = records[i];
+
+		const auto obj = objects.GetById(i);
+		if (!obj.IsValid())
+		{
+			record = { 0, -1, -1, 0, 0 };
+			continue;
+		}
+
+		const auto object = static_cast<const UObject*>(obj.GetAddress());
+
+		record.Address = reinterpret_cast<uintptr_t>(object);
+		record.Class = GetObjectIndex(obj.GetClass());
+		record.Outer = GetObjectIndex(obj.GetOuter());
+
+		const auto row = obj.GetRow();
+		if (row != ReflectionSnapshot::NullRow)
+		{
+			record.NameIndex = snapshot.GetNameIndex(row);
+			record.NameNumber = snapshot.GetNameNumber(row);
+		}
+		else
+		{
+			record.NameIndex = object->NamePrivate.ComparisonIndex;
+			record.NameNumber = object->NamePrivate.Number;
+		}
+	}
+
+	std::string blob;
+	std::vector<uint32_t> offsets;
+	offsets.reserve(namesNum + 1);
+	for (auto i = 0u; i < namesNum; ++i)
+	{
+		offsets.push_back(static_cast<uint32_t>(blob.size()));
+		if (names.IsValid(i))
+		{
+			const auto name = names.GetViewById(i);
+			blob.append(name.data(), name.size());
+		}
+	}
+	offsets.push_back(static_cast<uint32_t>(blob.size()));
+
+	Header header;
+	memset(&header, 0, sizeof(header));
+	header.Magic = Magic;
+	header.Version = Version;
+	header.NamesAddress = reinterpret_cast<uintptr_t>(NamesStore::GetAddress());
+	header.ObjectsAddress = reinterpret_cast<uintptr_t>(ObjectsStore::GetAddress());
+	header.NamesNum = static_cast<uint32_t>(namesNum);
+	header.ObjectsNum = static_cast<uint32_t>(objectsNum);
+	header.ObjectsOffset = sizeof(Header);
+	header.NameOffsetsOffset = header.ObjectsOffset + records.size() * sizeof(ObjectRecord);
+	header.NamesOffset = header.NameOffsetsOffset + offsets.size() * sizeof(uint32_t);
+
+	std::string content;
+	content.reserve(header.NamesOffset + blob.size());
+	Append(content, &header, sizeof(header));
+	Append(content, records.data(), records.size() * sizeof(ObjectRecord));
+	Append(content, offsets.data(), offsets.size() * sizeof(uint32_t));
+	content += blob;
+
+	OutputWriter::Write(path + "/" + FileName, std::move(content));
+}
+
+void ArraysDump::WriteText(const std::string& path)
+{
+	{
+		const NamesStore names;
+
+		std::ofstream o(path + "/" + "NamesDump.txt");
+		tfm::format(o, "Address: %P\n\n", NamesStore::GetAddress());
+
+		WriteChunked(o, names.GetNamesNum(), [&](std::ostream& os, size_t i)
+		{
+			if (names.IsValid(i))
+			{
+				tfm::format(os, "[%06i] %s\n", i, names.GetViewById(i));
+			}
+		});
+	}
+	{
+		const ObjectsStore objects;
+
+		std::ofstream o(path + "/" + "ObjectsDump.txt");
+		tfm::format(o, "Address: %P\n\n", ObjectsStore::GetAddress());
+
+		WriteChunked(o, objects.GetObjectsNum(), [&](std::ostream& os, size_t i)
+		{
+			const auto obj = objects.GetById(i);
+			if (obj.IsValid())
+			{
+				tfm::format(os, "[%06i] %-100s 0x%P\n", obj.GetIndex(), obj.GetFullName(), obj.GetAddress());
+			}
+		});
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+/// <summary>
+/// Dumps the global names and objects arrays.
+/// The binary dump can be mapped and used in place: a header, the object records, the offsets of the names
+/// and the blob with the characters of all names. Every section starts at the offset stored in the header.
+/// The text dump (NamesDump.txt and ObjectsDump.txt) is rendered in parallel chunks which get written in order.
+/// </summary>
+class ArraysDump
+{
+public:
+	/// <summary>The name of the binary dump in the output directory.</summary>
+	static constexpr const char* FileName = "ArraysDump.bin";
+
+	/// <summary>"UDMP" in little endian.</summary>
+	static constexpr uint32_t Magic = 0x504D4455;
+
+	/// <summary>Must be increased whenever the layout of the binary dump changes.</summary>
+	static constexpr uint32_t Version = 1;
+
+	struct Header
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		uint64_t NamesAddress;
+		uint64_t ObjectsAddress;
+		uint32_t NamesNum;
+		uint32_t ObjectsNum;
+		/// <summary>File offset of the ObjectRecord[ObjectsNum] array.</summary>
+		uint64_t ObjectsOffset;
+		/// <summary>File offset of the uint32_t[NamesNum + 1] array, name i is [offsets[i], offsets[i + 1]) of the blob.</summary>
+		uint64_t NameOffsetsOffset;
+		/// <summary>File offset of the characters of all names (without terminators).</summary>
+		uint64_t NamesOffset;
+	};
+
+	/// <summary>An object. The class and outer are object indices, -1 if they are null.</summary>
+	struct ObjectRecord
+	{
+		uint64_t Address;
+		int32_t Class;
+		int32_t Outer;
+		int32_t NameIndex;
+		int32_t NameNumber;
+	};
+
+	/// <summary>Writes the binary dump.</summary>
+	/// <param name="path">The output directory.</param>
+	static void WriteBinary(const std::string& path);
+
+	/// <summary>Writes the text dumps, the chunks are rendered on all cores.</summary>
+	/// <param name="path">The output directory.</param>
+	static void WriteText(const std::string& path);
+};
@@ -0,0 +1,154 @@
+#include "ClassHierarchy.hpp"
+
+#include <vector>
+
+#include "ReflectionSnapshot.hpp"
+
+namespace
+{
+	struct HierarchyData
+	{
+		bool Initialized = false;
+
+		/// <summary>
+		/// The id of every snapshot row, <see cref="ClassHierarchy::InvalidId" /> for rows which are no structs and for structs
+		/// whose super chain does not reach a root through captured structs.
+		/// </summary>
+		std::vector<int32_t> Ids;
+
+		/// <summary>The end of the id range of the structs deriving from the struct with the id.</summary>
+		std::vector<int32_t> Ends;
+	};
+
+	HierarchyData data;
+
+	bool IsStruct(const ReflectionSnapshot& snapshot, int32_t row)
+	{
+		const auto shape = snapshot.GetShape(row);
+		return shape == ReflectionSnapshot::Shape::Struct || shape == ReflectionSnapshot::Shape::Function;
+	}
+}
+
+constexpr int32_t ClassHierarchy::InvalidId;
+
+const int32_t* ClassHierarchy::ends = nullptr;
+
+bool ClassHierarchy::Initialize()
+{
+	if (data.Initialized)
+	{
+		return true;
+	}
+
+	if (!ReflectionSnapshot::IsInitialized())
+	{
+		return false;
+	}
+
+	const ReflectionSnapshot snapshot;
+	const auto count = static_cast<int32_t>(snapshot.GetRowsNum());
+
+	//build the child lists (compressed, indexed by the row of the super struct)
+	std::vector<int32_t> firstChild(count + 1, 0);
+	std::vector<int32_t> roots;
+	for (auto row = 0; row < count; ++row)
+	{
+		if (!IsStruct(snapshot, row))
+		{
+			continue;
+		}
+
+		//a struct whose super is not a captured struct stays out of the index with its subtree, IsA walks their chains
+		const auto super = snapshot.GetSuper(row);
+		if (super == ReflectionSnapshot::NullRow)
+		{
+			roots.push_back(row);
+		}
+		else if (super != row && IsStruct(snapshot, super))
+		{
+			++firstChild[super + 1];
+		}
+	}
+	for (auto row = 0; row < count; ++row)
+	{
+		firstChild[row + 1] += firstChild[row];
+	}
+
+	std::vector<int32_t> childRows(firstChild[count]);
+	{
+		auto next = firstChild;
+		for (auto row = 0; row < count; ++row)
+		{
+			if (!IsStruct(snapshot, row))
+			{
+				continue;
+			}
+
+			const auto super = snapshot.GetSuper(row);
+			if (super != ReflectionSnapshot::NullRow && super != row && IsStruct(snapshot, super))
+			{
+				childRows[next[super]++] = row;
+			}
+		}
+	}
+
+	//number the structs in DFS pre-order and remember where the subtree of each struct ends
+	data.Ids.assign(count, InvalidId);
+	data.Ends.clear();
+
+	struct Frame
+	{
+		int32_t Row;
+		int32_t NextChild;
+	};
+	std::vector<Frame> stack;
+
+	for (auto root : roots)
+	{
+		data.Ids[root] = static_cast<int32_t>(data.Ends.size());
+		data.Ends.push_back(0);
+		stack.push_back({ root, firstChild[root] });
+
+		while (!stack.empty())
+		{
+			auto& top = stack.back();
+			if (top.NextChild == firstChild[top.Row + 1])
+			{
+				data.Ends[data.Ids[top.Row]] = static_cast<int32_t>(data.Ends.size());
+				stack.pop_back();
+				continue;
+			}
+
+			const auto child = childRows[top.NextChild++];
+			if (data.Ids[child] != InvalidId)
+			{
+				continue;
+			}
+
+			data.Ids[child] = static_cast<int32_t>(data.Ends.size());
+			data.Ends.push_back(0);
+			stack.push_back({ child, firstChild[child] });
+		}
+	}
+
+	ends = data.Ends.data();
+
+	data.Initialized = true;
+
+	return true;
+}
+
+int32_t ClassHierarchy::GetId(const UEObject& structObj) const
+{
+	if (!data.Initialized)
+	{
+		return InvalidId;
+	}
+
+	const auto row = structObj.GetRow();
+	if (row == ReflectionSnapshot::NullRow)
+	{
+		return InvalidId;
+	}
+	return data.Ids[row];
+}
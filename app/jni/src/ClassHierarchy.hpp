@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+
+#include "UE4/GenericTypes.hpp"
+
+/// <summary>
+/// Interval numbering of the inheritance tree of all structs and classes captured by the reflection snapshot.
+/// Every struct gets a dense id in DFS pre-order, so all structs which derive from it have ids in the range
+/// [id, end) and checking inheritance becomes two integer comparisons instead of a SuperStruct walk.
+/// </summary>
+class ClassHierarchy
+{
+public:
+	/// <summary>The id of a struct which is not part of the index.</summary>
+	static constexpr int32_t InvalidId = -1;
+
+	/// <summary>
+	/// Builds the index from the reflection snapshot.
+	/// Must be called after <see cref="ReflectionSnapshot::Initialize()" />.
+	/// </summary>
+	/// <returns>true if it succeeds, false if it fails.</returns>
+	static bool Initialize();
+
+	/// <summary>Gets the dense id of the struct.</summary>
+	/// <param name="structObj">The struct or class.</param>
+	/// <returns>
+	/// The id or <see cref="InvalidId" /> if the struct was created after the index got built or one of its super structs
+	/// was not captured, the super chain must be walked then.
+	/// </returns>
+	int32_t GetId(const UEObject& structObj) const;
+
+	/// <summary>Checks if the struct with the given id derives from (or is) the other struct.</summary>
+	/// <param name="id">The id of the struct to check.</param>
+	/// <param name="baseId">The id of the base struct.</param>
+	/// <returns>true if the struct derives from the base struct.</returns>
+	bool IsChildOf(int32_t id, int32_t baseId) const
+	{
+		return baseId <= id && id < ends[baseId];
+	}
+
+private:
+	static const int32_t* ends;
+};
@@ -441,3 +441,104 @@ public:
 	class UNumericProperty* UnderlyingProp; //0x0070
 	class UEnum* Enum; //0x0078
 }; //Size: 0x0080
+
+class FNameEntry
+{
+public:
+	FNameEntry* HashNext;
+	__int32 Index;
+	union
+	{
+		char AnsiName[1024];
+		wchar_t WideName[1024];
+	};
+
+	const char* GetName() const
+	{
+		return AnsiName;
+	}
+};
+
+template<typename ElementType, int32_t MaxTotalElements, int32_t ElementsPerChunk>
+class TStaticIndirectArrayThreadSafeRead
+{
+public:
+	int32_t Num() const
+	{
+		return NumElements;
+	}
+
+	bool IsValidIndex(int32_t index) const
+	{
+		return index >= 0 && index < Num() && GetById(index) != nullptr;
+	}
+
+	ElementType const* const& GetById(int32_t index) const
+	{
+		return *GetItemPtr(index);
+	}
+
+	int32_t GetChunksNum() const
+	{
+		return NumChunks;
+	}
+
+	ElementType const* const* GetChunk(int32_t index) const
+	{
+		return Chunks[index];
+	}
+
+	static constexpr int32_t GetElementsPerChunk()
+	{
+		return ElementsPerChunk;
+	}
+
+	enum
+	{
+		ChunkTableSize = (MaxTotalElements + ElementsPerChunk - 1) / ElementsPerChunk
+	};
+
+	ElementType** Chunks[ChunkTableSize];
+	__int32 NumElements;
+	__int32 NumChunks;
+
+private:
+	ElementType const* const* GetItemPtr(int32_t Index) const
+	{
+		int32_t ChunkIndex = Index / ElementsPerChunk;
+		int32_t WithinChunkIndex = Index % ElementsPerChunk;
+		ElementType** Chunk = Chunks[ChunkIndex];
+		return Chunk + WithinChunkIndex;
+	}
+};
+
+using TNameEntryArray = TStaticIndirectArrayThreadSafeRead<FNameEntry, 2 * 1024 * 1024, 16384>;
+
+class FUObjectItem
+{
+public:
+	UObject* Object; //0x0000
+	__int32 Flags; //0x0008
+	__int32 ClusterIndex; //0x000C
+	__int32 SerialNumber; //0x0010
+	char pad1[0x4];
+};
+
+class TUObjectArray
+{
+public:
+	FUObjectItem* Objects;
+	int32_t MaxElements;
+	int32_t NumElements;
+};
+
+class FUObjectArray
+{
+public:
+	__int32 ObjFirstGCIndex; //0x0000
+	__int32 ObjLastNonGCIndex; //0x0004
+	__int32 MaxObjectsNotConsideredByGC; //0x0008
+	__int32 OpenForDisregardForGC; //0x000C
+
+	TUObjectArray ObjObjects; //0x0010
+};
@@ -129,24 +129,67 @@ public:
 
 	return name;
 })"),
-			PredefinedMethod::Inline(R"(	template<typename T>
-	static T* FindObject(const std::string& name)
+			PredefinedMethod::Default("static UObject* FindObject(uint64_t hash, const std::string& name)", R"(UObject* UObject::FindObject(uint64_t hash, const std::string& name)
+{
+	//full name hash -> object index, built on the first lookup and rebuilt on a miss if objects were added or removed
+	static std::mutex mutex;
+	static std::unordered_multimap<uint64_t, int32_t> index;
+	static int32_t indexedNum = -1;
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	while (true)
 	{
-		for (int i = 0; i < GetGlobalObjects().Num(); ++i)
+		UObject* found = nullptr;
+		int32_t foundIndex = 0;
+
+		const auto range = index.equal_range(hash);
+		for (auto it = range.first; it != range.second; ++it)
 		{
-			auto object = GetGlobalObjects().GetByIndex(i);
-	
-			if (object == nullptr)
+			if (found != nullptr && it->second > foundIndex)
 			{
 				continue;
 			}
-	
-			if (object->GetFullName() == name)
+
+			auto object = GetGlobalObjects().GetByIndex(it->second);
+			if (object != nullptr && object->GetFullName() == name)
+			{
+				found = object;
+				foundIndex = it->second;
+			}
+		}
+
+		if (found != nullptr || indexedNum == GetGlobalObjects().Num())
+		{
+			return found;
+		}
+
+		index.clear();
+		indexedNum = GetGlobalObjects().Num();
+		index.reserve(indexedNum);
+		for (int32_t i = 0; i < indexedNum; ++i)
+		{
+			auto object = GetGlobalObjects().GetByIndex(i);
+			if (object != nullptr)
 			{
-				return static_cast<T*>(object);
+				index.emplace(HashName(object->GetFullName()), i);
 			}
 		}
-		return nullptr;
+	}
+})"),
+			PredefinedMethod::Inline(R"(	template<typename T>
+	static T* FindObject(uint64_t hash, const std::string& name)
+	{
+		return static_cast<T*>(FindObject(hash, name));
+	})"),
+			PredefinedMethod::Inline(R"(	template<typename T>
+	static T* FindObject(const std::string& name)
+	{
+		return static_cast<T*>(FindObject(HashName(name), name));
+	})"),
+			PredefinedMethod::Inline(R"(	static UClass* FindClass(uint64_t hash, const std::string& name)
+	{
+		return FindObject<UClass>(hash, name);
 	})"),
 			PredefinedMethod::Inline(R"(	static UClass* FindClass(const std::string& name)
 	{
@@ -196,6 +239,14 @@ public:
 		return  gameVersion;
 	}
 
+	std::vector<Signature> GetSignatures() const override
+	{
+		return {
+			{ "GetNames", Signature::Kind::Offset, "", 0x3E799F4 },
+			{ "GUObjectArray", Signature::Kind::Offset, "", 0xA772850 }
+		};
+	}
+
 	std::string GetNamespaceName() const override
 	{
 		return "SDK";
@@ -208,7 +259,18 @@ public:
 
 	std::string GetBasicDeclarations() const override
 	{
-		return R"(template<typename Fn>
+		return R"(// 64 bit FNV-1a hash of an object name, the generator emits the hashes of the full names next to the strings
+inline uint64_t HashName(const std::string& name)
+{
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (auto c : name)
+    {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001B3ull;
+    }
+    return hash;
+}
+
+template<typename Fn>
     inline Fn GetVFunction(void *thiz, int idx)
     {
 	auto VTable = *reinterpret_cast<void***>(const_cast<void*>(thiz));
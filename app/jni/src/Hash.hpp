@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+/// <summary>
+/// 64 bit FNV-1a hash. The values are stable across runs and platforms,
+/// so they can be stored in files and emitted into the generated code.
+/// </summary>
+class Fnv1a
+{
+public:
+	static constexpr uint64_t OffsetBasis = 0xCBF29CE484222325ull;
+	static constexpr uint64_t Prime = 0x100000001B3ull;
+
+	/// <summary>Hashes the string.</summary>
+	/// <param name="data">The string.</param>
+	/// <returns>The hash.</returns>
+	static constexpr uint64_t Hash(std::string_view data)
+	{
+		auto hash = OffsetBasis;
+		for (auto c : data)
+		{
+			hash = (hash ^ static_cast<uint8_t>(c)) * Prime;
+		}
+		return hash;
+	}
+
+	/// <summary>Adds the string and its length, so consecutive strings can not run into each other.</summary>
+	/// <param name="data">The string.</param>
+	/// <returns>This hasher.</returns>
+	Fnv1a& Add(std::string_view data)
+	{
+		Add(static_cast<uint64_t>(data.size()));
+		for (auto c : data)
+		{
+			hash = (hash ^ static_cast<uint8_t>(c)) * Prime;
+		}
+		return *this;
+	}
+
+	/// <summary>Adds the bytes of the integral or enum value.</summary>
+	/// <param name="value">The value.</param>
+	/// <returns>This hasher.</returns>
+	template<typename T, typename = std::enable_if_t<std::is_integral<T>::value || std::is_enum<T>::value>>
+	Fnv1a& Add(T value)
+	{
+		auto bits = static_cast<uint64_t>(value);
+		for (auto i = 0u; i < sizeof(T); ++i, bits >>= 8)
+		{
+			hash = (hash ^ (bits & 0xFF)) * Prime;
+		}
+		return *this;
+	}
+
+	/// <summary>Gets the hash of everything added so far.</summary>
+	/// <returns>The hash.</returns>
+	uint64_t Get() const { return hash; }
+
+private:
+	uint64_t hash = OffsetBasis;
+};
@@ -0,0 +1,53 @@
+#include "Main.h"
+
+#include "Logger.hpp"
+#include "NamesStore.hpp"
+#include "ObjectsStore.hpp"
+#include "SnapshotFile.hpp"
+
+/// <summary>
+/// Entry point of the host build: generates the SDK from a snapshot file which was saved on the device.
+/// </summary>
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        fprintf(stderr, "Usage: %s <snapshot file> <output directory>\n", argv[0]);
+        return 1;
+    }
+
+    //the generator log is not open yet
+    Logger::SetStream(&std::cerr);
+
+    SnapshotFile::Header header;
+    const auto loaded = SnapshotFile::Load(argv[1], header);
+
+    Logger::SetStream(nullptr);
+
+    if (!loaded)
+    {
+        return 1;
+    }
+
+    if (!NamesStore::Initialize(reinterpret_cast<void*>(header.NamesAddress)))
+    {
+        LOGE("NamesStore::Initialize failed");
+        return 1;
+    }
+
+    if (!ObjectsStore::Initialize(reinterpret_cast<void*>(header.ObjectsAddress)))
+    {
+        LOGE("ObjectsStore::Initialize failed");
+        return 1;
+    }
+
+    if (!InitializeGenerator())
+    {
+        return 1;
+    }
+
+    Generate(argv[2]);
+
+    LOGE("Finished!");
+    return 0;
+}
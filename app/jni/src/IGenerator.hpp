@@ -1,10 +1,13 @@
 #pragma once
 
+#include <chrono>
 #include <string>
 #include <unordered_map>
 #include <vector>
 #include <iterator>
 
+#include "PatternScanner.hpp"
+
 
 class IGenerator
 {
@@ -49,6 +52,37 @@ public:
 	/// <returns>The version of the game.</returns>
 	virtual std::string GetGameVersion() const = 0;
 
+	/// <summary>
+	/// Gets how long the number of names and objects must stay unchanged before the generation starts.
+	/// The engine keeps loading objects after libUE4.so is mapped, a longer window trades start up time for completeness.
+	/// </summary>
+	/// <returns>The readiness window.</returns>
+	virtual std::chrono::milliseconds GetReadinessWindow() const
+	{
+		return std::chrono::seconds(5);
+	}
+
+	/// <summary>
+	/// Gets how long the generator waits for the names and objects at most.
+	/// If the counts are still growing afterwards the generation starts anyway.
+	/// </summary>
+	/// <returns>The readiness timeout.</returns>
+	virtual std::chrono::milliseconds GetReadinessTimeout() const
+	{
+		return std::chrono::minutes(5);
+	}
+
+	/// <summary>
+	/// Gets the signatures which locate the globals in libUE4.so, see <see cref="Signature" />.
+	/// The signatures of a global are tried in order, so the patterns which survive game updates come first and a fixed
+	/// offset of one build can be the last resort.
+	/// </summary>
+	/// <returns>The signatures of all globals.</returns>
+	virtual std::vector<Signature> GetSignatures() const
+	{
+		return {};
+	}
+
 	/// <summary>
 	/// Check if the generator should dump the object and name arrays.
 	/// </summary>
@@ -58,6 +92,26 @@ public:
 		return true;
 	}
 
+	/// <summary>
+	/// Check if the arrays (<see cref="ShouldDumpArrays()" />) should also get dumped as text.
+	/// The binary dump is always written, the text dump contains the full name of every object and gets large.
+	/// </summary>
+	/// <returns>true if the text dumps should get written.</returns>
+	virtual bool ShouldDumpArraysAsText() const
+	{
+		return false;
+	}
+
+	/// <summary>
+	/// Check if the memory the generator reads should get saved into a snapshot file (<see cref="SnapshotFile" />).
+	/// The host build of the generator runs against this file.
+	/// </summary>
+	/// <returns>true if the snapshot should get saved.</returns>
+	virtual bool ShouldSaveSnapshot() const
+	{
+		return false;
+	}
+
 	/// <summary>
 	/// Check if the generator should generate empty files (no classes, structs, ...).
 	/// </summary>
@@ -108,6 +162,17 @@ public:
 		return true;
 	}
 
+	/// <summary>
+	/// Check if the generated files should be written through io_uring.
+	/// The seccomp filter of Android apps traps io_uring, so only enable this if the generator runs outside of an app.
+	/// If io_uring is not available the files are written with write().
+	/// </summary>
+	/// <returns>true if io_uring should be used.</returns>
+	virtual bool ShouldUseIoUring() const
+	{
+		return false;
+	}
+
 	/// <summary>
 	/// Gets namespace name for the classes. If the name is empty no namespace gets generated.
 	/// </summary>
@@ -193,40 +258,26 @@ public:
 
 	/// <summary>
 	/// Gets the predefined members of the specific class.
+	/// The members belong to the generator, the packages reference them instead of copying.
 	/// </summary>
 	/// <param name="name">The name of the class.</param>
-	/// <param name="members">[out] The predefined members.</param>
-	/// <returns>true if predefined members are found.</returns>
-	virtual bool GetPredefinedClassMembers(const std::string& name, std::vector<PredefinedMember>& members) const
+	/// <returns>The predefined members, nullptr if the class has none.</returns>
+	virtual const std::vector<PredefinedMember>* GetPredefinedClassMembers(const std::string& name) const
 	{
 		auto it = predefinedMembers.find(name);
-		if (it != std::end(predefinedMembers))
-		{
-			std::copy(std::begin(it->second), std::end(it->second), std::back_inserter(members));
-
-			return true;
-		}
-
-		return false;
+		return it != std::end(predefinedMembers) ? &it->second : nullptr;
 	}
 
 	/// <summary>
 	/// Gets the static predefined members of the specific class.
+	/// The members belong to the generator, the packages reference them instead of copying.
 	/// </summary>
 	/// <param name="name">The name of the class.</param>
-	/// <param name="members">[out] The predefined members.</param>
-	/// <returns>true if predefined members are found.</returns>
-	virtual bool GetPredefinedClassStaticMembers(const std::string& name, std::vector<PredefinedMember>& members) const
+	/// <returns>The predefined members, nullptr if the class has none.</returns>
+	virtual const std::vector<PredefinedMember>* GetPredefinedClassStaticMembers(const std::string& name) const
 	{
 		auto it = predefinedStaticMembers.find(name);
-		if (it != std::end(predefinedStaticMembers))
-		{
-			std::copy(std::begin(it->second), std::end(it->second), std::back_inserter(members));
-
-			return true;
-		}
-
-		return false;
+		return it != std::end(predefinedStaticMembers) ? &it->second : nullptr;
 	}
 
 	using VirtualFunctionPatterns = std::vector<std::tuple<const char*, const char*, size_t, const char*>>;
@@ -281,21 +332,16 @@ public:
 		}
 	};
 
-	/// <summary>Gets the predefined methods of the specific class.</summary>
-	/// <param name="className">The name of the class.</param>
-	/// <param name="methods">[out] The predefined methods.</param>
-	/// <returns>true if predefined methods are found.</returns>
-	virtual bool GetPredefinedClassMethods(const std::string& name, std::vector<PredefinedMethod>& methods) const
+	/// <summary>
+	/// Gets the predefined methods of the specific class.
+	/// The methods belong to the generator, the packages reference them instead of copying.
+	/// </summary>
+	/// <param name="name">The name of the class.</param>
+	/// <returns>The predefined methods, nullptr if the class has none.</returns>
+	virtual const std::vector<PredefinedMethod>* GetPredefinedClassMethods(const std::string& name) const
 	{
 		auto it = predefinedMethods.find(name);
-		if (it != std::end(predefinedMethods))
-		{
-			std::copy(std::begin(it->second), std::end(it->second), std::back_inserter(methods));
-
-			return true;
-		}
-
-		return false;
+		return it != std::end(predefinedMethods) ? &it->second : nullptr;
 	}
 
 protected:
@@ -1,7 +1,9 @@
 #ifndef INCLUDES_H
 #define INCLUDES_H
 
+#ifdef __ANDROID__
 #include <jni.h>
+#endif
 #include <string>
 #include <cstdlib>
 #include <math.h>
@@ -27,7 +29,9 @@
 #include <sys/resource.h>
 #include <sys/uio.h>
 #include <fcntl.h>
+#ifdef __ANDROID__
 #include <android/log.h>
+#endif
 #include <pthread.h>
 #include <dirent.h>
 #include <list>
@@ -56,10 +60,18 @@ enum daLogType {
 //Telegram @Unknown_Xd
 #define TAG "Parth-SDKGen"
 
+#ifdef __ANDROID__
 #define LOGD(...) ((void)__android_log_print(daDEBUG, TAG, __VA_ARGS__))
 #define LOGE(...) ((void)__android_log_print(daERROR, TAG, __VA_ARGS__))
 #define LOGI(...) ((void)__android_log_print(daINFO,  TAG, __VA_ARGS__))
 #define LOGW(...) ((void)__android_log_print(daWARN,  TAG, __VA_ARGS__))
+#else
+//host builds log to stderr
+#define LOGD(...) ((void)fprintf(stderr, TAG ": " __VA_ARGS__), (void)fputc('\n', stderr))
+#define LOGE(...) ((void)fprintf(stderr, TAG ": " __VA_ARGS__), (void)fputc('\n', stderr))
+#define LOGI(...) ((void)fprintf(stderr, TAG ": " __VA_ARGS__), (void)fputc('\n', stderr))
+#define LOGW(...) ((void)fprintf(stderr, TAG ": " __VA_ARGS__), (void)fputc('\n', stderr))
+#endif
 
 
 #endif
@@ -1,14 +1,26 @@
 #include "Logger.hpp"
 
+#include <mutex>
+
+namespace
+{
+	//packages are generated in parallel
+	std::mutex mutex;
+}
+
 std::ostream* Logger::stream = nullptr;
 
 void Logger::SetStream(std::ostream* _stream)
 {
+	std::lock_guard<std::mutex> lock(mutex);
+
 	stream = _stream;
 }
 
 void Logger::Log(const std::string& message)
 {
+	std::lock_guard<std::mutex> lock(mutex);
+
 	if (stream != nullptr)
 	{
 		(*stream) << message << '\n' << std::flush;
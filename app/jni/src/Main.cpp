@@ -11,6 +11,14 @@
 
 #include "ObjectsStore.hpp"
 #include "NamesStore.hpp"
+#include "ReflectionSnapshot.hpp"
+#include "ClassHierarchy.hpp"
+#include "ThreadPool.hpp"
+#include "OutputWriter.hpp"
+#include "Manifest.hpp"
+#include "Hash.hpp"
+#include "ArraysDump.hpp"
+#include "SnapshotFile.hpp"
 #include "Package.hpp"
 #include "NameValidator.hpp"
 
@@ -25,30 +33,125 @@ extern IGenerator* generator;
 //SDKGen by @Unknown_Yt
 void Dump(std::string path)
 {
+	ArraysDump::WriteBinary(path);
+
+	if (generator->ShouldDumpArraysAsText())
 	{
+		ArraysDump::WriteText(path);
+	}
+}
 
-		std::ofstream o(path + "/" + "NamesDump.txt");
-		tfm::format(o, "Address: %P\n\n", NamesStore::GetAddress());
+/// <summary>
+/// Prints the Init() function which fills the object slot tables of all packages.
+/// </summary>
+/// <param name="os">[in] The stream to print to.</param>
+/// <param name="packages">The records of the saved packages.</param>
+void PrintObjectSlotsInit(std::ostream& os, const std::vector<PackageRecord>& packages)
+{
+    PrintSectionHeader(os, "Object Slots");
 
-		for (auto name : NamesStore())
+    size_t slotsNum = 0;
+    for (auto&& package : packages)
+    {
+        if (package.ObjectSlotsNum != 0)
+        {
+            const auto prefix = Package::GetObjectSlotsPrefix(package.Name);
+            tfm::format(os, "extern UObject* %s_Objects[];\n", prefix);
+            tfm::format(os, "extern const FObjectSlot %s_ObjectSlots[];\n", prefix);
+            slotsNum += package.ObjectSlotsNum;
+        }
+    }
+
+    os << "\nstruct FObjectSlotTable\n{\n\tUObject** Objects;\n\tconst FObjectSlot* Slots;\n\tint32_t Num;\n};\n\n";
+
+    os << "static const FObjectSlotTable ObjectSlotTables[] =\n{\n";
+    for (auto&& package : packages)
+    {
+        if (package.ObjectSlotsNum != 0)
+        {
+            const auto prefix = Package::GetObjectSlotsPrefix(package.Name);
+            tfm::format(os, "\t{ %s_Objects, %s_ObjectSlots, %d },\n", prefix, prefix, package.ObjectSlotsNum);
+        }
+    }
+    //an array can not be empty
+    os << "\t{ nullptr, nullptr, 0 }\n};\n\n";
+
+    if (generator->ShouldUseStrings())
+    {
+        //the full names are left out of the binary with xor encoded strings, the hash alone decides then
+        const auto xorStrings = generator->ShouldXorStrings();
+        tfm::format(os, R"(bool Init()
+{
+	//several slots can share a hash, %s
+	std::unordered_multimap<uint64_t, std::pair<const FObjectSlot*, UObject**>> slots;
+	slots.reserve(%d);
+	for (auto&& table : ObjectSlotTables)
+	{
+		for (auto i = 0; i < table.Num; ++i)
 		{
-			tfm::format(o, "[%06i] %s\n", name.Index, name.NamePrivate);
+			table.Objects[i] = nullptr;
+			slots.emplace(table.Slots[i].Hash, std::make_pair(&table.Slots[i], &table.Objects[i]));
 		}
+	}
+
+	size_t resolved = 0;
+	auto& objects = UObject::GetGlobalObjects();
+	for (auto i = 0; i < objects.Num() && resolved < slots.size(); ++i)
+	{
+		auto object = objects.GetByIndex(i);
+		if (object == nullptr)
+		{
+			continue;
 		}
+
+		const auto fullName = object->GetFullName();
+		const auto range = slots.equal_range(HashName(fullName));
+		for (auto it = range.first; it != range.second; ++it)
 		{
-		std::ofstream o(path + "/" + "ObjectsDump.txt");
-		tfm::format(o, "Address: %P\n\n", ObjectsStore::GetAddress());
+			if (*it->second.second == nullptr%s)
+			{
+				*it->second.second = object;
+				++resolved;
+			}
+		}
+	}
+	return resolved == slots.size();
+}
+)", xorStrings ? "every one of them takes the object" : "the full name decides which of them an object takes",
+            slotsNum,
+            xorStrings ? "" : " && fullName == it->second.first->FullName");
+    }
+    else
+    {
+        os << R"(bool Init()
+{
+	auto& objects = UObject::GetGlobalObjects();
 
-		for (auto obj : ObjectsStore())
+	auto resolved = true;
+	for (auto&& table : ObjectSlotTables)
+	{
+		for (auto i = 0; i < table.Num; ++i)
 		{
-			tfm::format(o, "[%06i] %-100s 0x%P\n", obj.GetIndex(), obj.GetFullName(), obj.GetAddress());
+			auto& slot = table.Slots[i];
+			auto item = objects.GetItemByIndex(slot.Index);
+			if (item == nullptr || item->Object == nullptr || (slot.SerialNumber != 0 && item->SerialNumber != slot.SerialNumber))
+			{
+				table.Objects[i] = nullptr;
+				resolved = false;
+				continue;
+			}
+			table.Objects[i] = item->Object;
 		}
 	}
+	return resolved;
+}
+)";
+    }
 }
 
-void SaveSDKHeader(std::string path, const std::unordered_map<UEObject, bool>& processedObjects, const std::vector<std::unique_ptr<Package>>& packages)
+void SaveSDKHeader(std::string path, const std::unordered_map<UEObject, bool>& processedObjects, const std::vector<PackageRecord>& packages)
 {
-    std::ofstream os(path + "/" +  "SDK.hpp");
+    std::ostringstream os;
 
     os << "#pragma once\n\n"
         << tfm::format("// %s (%s) SDKGen by @Unknown \n", generator->GetGameName(), generator->GetGameVersion());
@@ -63,43 +166,78 @@ void SaveSDKHeader(std::string path, const std::unordered_map<UEObject, bool>& p
 
     {
         {
-            std::ofstream os2(path + "/SDK" + "/" + tfm::format("%s_Basic.hpp", generator->GetGameNameShort()));
+            std::ostringstream os2;
             std::vector<std::string> incs = {
             "<iostream>",
             "<string>",
             "<unordered_set>",
+            "<unordered_map>",
+            "<mutex>",
             "<codecvt>"
             };
             PrintFileHeader(os2, incs, true);
             
             os2 << generator->GetBasicDeclarations() << "\n";
 
+            os2 << R"(// Slot of a class or function used by the generated wrappers
+struct FObjectSlot
+{
+	uint64_t Hash;        // HashName of the full name
+)";
+            if (!generator->ShouldUseStrings())
+            {
+                os2 << "\tint32_t Index;        // index in GUObjectArray when the SDK was generated\n";
+                os2 << "\tint32_t SerialNumber; // serial number of the index, 0 if none was assigned\n";
+            }
+            else if (!generator->ShouldXorStrings())
+            {
+                os2 << "\tconst char* FullName; // the full name, compared when the hash matches\n";
+            }
+            os2 << R"(};
+
+// Resolves the classes and functions of all generated wrappers with a single pass over GUObjectArray.
+// Must be called once GNames and GUObjectArray are set and before any StaticClass() or function wrapper is used.
+// Returns false if not all of them could be found.
+bool Init();
+)" << "\n";
+
             PrintFileFooter(os2);
 
+            OutputWriter::Write(path + "/SDK" + "/" + tfm::format("%s_Basic.hpp", generator->GetGameNameShort()), os2.str());
+
             os << "\n#include \"SDK/" << tfm::format("%s_Basic.hpp", generator->GetGameNameShort()) << "\"\n";
         }
         {
-            std::ofstream os2(path + "/SDK" +  "/" +  tfm::format("%s_Basic.cpp", generator->GetGameNameShort()));
+            std::ostringstream os2;
 
             PrintFileHeader(os2, { "\"../SDK.hpp\"" }, false);
 
             os2 << generator->GetBasicDefinitions() << "\n";
 
+            PrintObjectSlotsInit(os2, packages);
+
             PrintFileFooter(os2);
+
+            OutputWriter::Write(path + "/SDK" + "/" + tfm::format("%s_Basic.cpp", generator->GetGameNameShort()), os2.str());
         }
     }
 
     using namespace cpplinq;
 
     //check for missing structs
-    const auto missing = from(processedObjects) >> where([](auto&& kv) { return kv.second == false; });
-    if (missing >> any())
+    //sorted by index, the order of the map depends on the order the packages were processed in
+    auto missing = from(processedObjects)
+        >> where([](auto&& kv) { return kv.second == false; })
+        >> select([](auto&& kv) { return kv.first.template Cast<UEStruct>(); })
+        >> to_vector();
+    std::sort(std::begin(missing), std::end(missing), [](auto&& lhs, auto&& rhs) { return lhs.GetIndex() < rhs.GetIndex(); });
+    if (!missing.empty())
     {
-        std::ofstream os2(path + "/SDK" + "/" + tfm::format("%s_MISSING.hpp", generator->GetGameNameShort()));
+        std::ostringstream os2;
 
         PrintFileHeader(os2, true);  
 		
-		for (auto&& s : missing >> select([](auto&& kv) { return kv.first.template Cast<UEStruct>(); }) >> experimental::container())
+		for (auto&& s : missing)
         {
             os2 << "// " << s.GetFullName() << "\n// ";
             os2 << tfm::format("0x%04X\n", s.GetPropertySize());
@@ -110,6 +248,8 @@ void SaveSDKHeader(std::string path, const std::unordered_map<UEObject, bool>& p
 
         PrintFileFooter(os2);
 
+        OutputWriter::Write(path + "/SDK" + "/" + tfm::format("%s_MISSING.hpp", generator->GetGameNameShort()), os2.str());
+
         os << "\n#include \"SDK/" << tfm::format("%s_MISSING.hpp", generator->GetGameNameShort()) << "\"\n";
     }
 
@@ -117,13 +257,41 @@ void SaveSDKHeader(std::string path, const std::unordered_map<UEObject, bool>& p
 
     for (auto&& package : packages)
     {
-        os << R"(#include "SDK/)" << GenerateFileName(FileContentType::Structs, *package) << "\"\n";
-        os << R"(#include "SDK/)" << GenerateFileName(FileContentType::Classes, *package) << "\"\n";
+        os << R"(#include "SDK/)" << GenerateFileName(FileContentType::Structs, package.Name) << "\"\n";
+        os << R"(#include "SDK/)" << GenerateFileName(FileContentType::Classes, package.Name) << "\"\n";
         if (generator->ShouldGenerateFunctionParametersFile())
         {
-            os << R"(#include "SDK/)" << GenerateFileName(FileContentType::FunctionParameters, *package) << "\"\n";
+            os << R"(#include "SDK/)" << GenerateFileName(FileContentType::FunctionParameters, package.Name) << "\"\n";
         }
     }
+
+    OutputWriter::Write(path + "/" + "SDK.hpp", os.str());
+}
+
+/// <summary>
+/// Computes the hash of the generator settings which change the generated files.
+/// </summary>
+/// <returns>The hash.</returns>
+uint64_t ComputeConfigHash()
+{
+    Fnv1a hasher;
+    hasher.Add(generator->GetGameName())
+        .Add(generator->GetGameNameShort())
+        .Add(generator->GetGameVersion())
+        .Add(generator->ShouldGenerateEmptyFiles())
+        .Add(generator->ShouldUseStrings())
+        .Add(generator->ShouldXorStrings())
+        .Add(generator->ShouldConvertStaticMethods())
+        .Add(generator->ShouldGenerateFunctionParametersFile())
+        .Add(generator->GetNamespaceName())
+        .Add(generator->GetGlobalMemberAlignment())
+        .Add(generator->GetBasicDeclarations())
+        .Add(generator->GetBasicDefinitions());
+    for (auto&& i : generator->GetIncludes())
+    {
+        hasher.Add(i);
+    }
+    return hasher.Get();
 }
 
 /// <summary>
@@ -132,85 +300,117 @@ void SaveSDKHeader(std::string path, const std::unordered_map<UEObject, bool>& p
 /// <param name="path">The path where to create the package files.</param>
 void ProcessPackages(std::string path)
 {
-    using namespace cpplinq;
-
     const auto sdkPath = path + "/SDK";
     mkdir(sdkPath.c_str(), 0777);
     
-    std::vector<std::unique_ptr<Package>> packages;
+    //the packages are rendered into buffers while the writer thread writes the previous ones
+    OutputWriter::Start(generator->ShouldUseIoUring());
 
-    std::unordered_map<UEObject, bool> processedObjects;
+    //packages which were generated from the same types by the previous run are not written again
+    Manifest manifest(Tools::GetBuildId("libUE4.so"), ComputeConfigHash());
+    auto previous = Manifest::Load(path);
+    if (previous.GetConfigHash() != manifest.GetConfigHash())
+    {
+        previous = Manifest();
+    }
+    else if (previous.GetBuildId() != manifest.GetBuildId())
+    {
+        Logger::Log("libUE4.so changed (%s -> %s), comparing the package hashes", previous.GetBuildId(), manifest.GetBuildId());
+    }
 
-    auto packageObjects = from(ObjectsStore())
-        >> select([](auto&& o) { return o.GetPackageObject(); })
-        >> where([](auto&& o) { return o.IsValid(); })
-        >> distinct()
-        >> to_vector();
+    const PackageIndex index;
+    const auto& packageObjects = index.GetPackages();
+
+    //every package marks the objects it visited in its own map, the maps get merged in package order afterwards
+    std::vector<std::unique_ptr<PackageRecord>> saved(packageObjects.size());
+    std::vector<std::unordered_map<UEObject, bool>> visited(packageObjects.size());
 
-    for (auto obj : packageObjects)
+    //a package is released as soon as its files are handed to the writer, only its record is kept
+    const ThreadPool pool;
+    pool.Run(packageObjects.size(), [&](size_t i)
     {
-        auto package = std::make_unique<Package>(obj);
+        Package package(packageObjects[i]);
 
-        package->Process(processedObjects);
-        if (package->Save(sdkPath))
+        package.Process(index.GetTypeObjects(i), visited[i]);
+        if (package.Save(sdkPath, previous))
         {
-            Package::PackageMap[obj] = package.get();
-
-            packages.emplace_back(std::move(package));
+            saved[i] = std::make_unique<PackageRecord>(package.GetRecord());
         }
-    }
+    });
+
+    std::vector<PackageRecord> packages;
+
+    std::unordered_map<UEObject, bool> processedObjects;
 
-    if (!packages.empty())
+    for (auto i = 0u; i < packageObjects.size(); ++i)
     {
-      
-        const PackageDependencyComparer comparer;
-        for (auto i = 0u; i < packages.size() - 1; ++i)
+        for (auto&& kv : visited[i])
         {
-            for (auto j = 0u; j < packages.size() - i - 1; ++j)
-            {
-                if (!comparer(packages[j], packages[j + 1]))
-                {
-                    std::swap(packages[j], packages[j + 1]);
-                }
-            }
+            processedObjects[kv.first] |= kv.second;
+        }
+
+        if (saved[i])
+        {
+            manifest.AddPackage(saved[i]->Name, saved[i]->Hash);
+
+            packages.emplace_back(std::move(*saved[i]));
+            saved[i].reset();
         }
     }
 
+    Package::SortByDependencies(packages);
+
     SaveSDKHeader(path, processedObjects, packages);
-}
 
-void *main_thread(void *) { 
+    manifest.Save(path);
 
-     sleep(70);
+    OutputWriter::Stop();
+}
 
-	if (!NamesStore::Initialize())
+/// <summary>
+/// Builds the name table, the reflection snapshot and the indices over the global stores and initializes the generator.
+/// The global names and objects stores must be initialized.
+/// </summary>
+/// <returns>true if it succeeds, false if it fails.</returns>
+bool InitializeGenerator()
+{
+    if (!NamesStore::InitializeTable())
     {
-        LOGE("NamesStore::Initialize failed");
-        return 0;
+        LOGE("NamesStore::InitializeTable failed");
+        return false;
     }
 
+    if (!ReflectionSnapshot::Initialize())
+    {
+        LOGE("ReflectionSnapshot::Initialize failed, reading the objects directly");
+    }
+    else if (!ClassHierarchy::Initialize())
+    {
+        LOGE("ClassHierarchy::Initialize failed, walking the super chains");
+    }
 
-    if (!ObjectsStore::Initialize())
+    if (!ObjectsStore::InitializeIndex())
     {
-        LOGE("ObjectsStore::Initialize failed");
-        return 0;
+        LOGE("ObjectsStore::InitializeIndex failed");
+        return false;
     }
 
 	
     if (!generator->Initialize())
     {
         LOGE("Initialize failed");
-        return 0;
+        return false;
     }
-   
-    std::string outputDirectory = generator->GetOutputDirectory(pkgName);
-    
-    #if defined(__LP64__)
-    outputDirectory += "/" + generator->GetGameNameShort() + "_(v" + generator->GetGameVersion() + ")_64Bit";
-    #else
-    outputDirectory += "/" + generator->GetGameNameShort() + "_(v" + generator->GetGameVersion() + ")_32Bit";
-    #endif
-    
+
+    return true;
+}
+
+/// <summary>
+/// Writes the log, the dumps and the SDK into the output directory.
+/// </summary>
+/// <param name="outputDirectory">The output directory.</param>
+void Generate(const std::string& outputDirectory)
+{
 	mkdir(outputDirectory.c_str(), 0777);
     
     std::ofstream log(outputDirectory + "/Unknown.log");
@@ -230,6 +430,107 @@ void *main_thread(void *) {
 
     Logger::Log("Generated, in %d seconds.", std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now() - begin).count());
     Logger::SetStream(nullptr);
+}
+
+#ifdef __ANDROID__
+/// <summary>
+/// Waits until the global names and objects stores exist and their counts stopped growing for the readiness window.
+/// Polls with a backoff from 50 ms to 1 s, the interval drops back to 50 ms whenever a count changes.
+/// </summary>
+/// <returns>true if the stores are ready, false if they are still empty after the readiness timeout.</returns>
+bool WaitForReadiness()
+{
+    using namespace std::chrono;
+
+    constexpr milliseconds MinInterval(50);
+    constexpr milliseconds MaxInterval(1000);
+
+    const auto window = generator->GetReadinessWindow();
+    const auto begin = steady_clock::now();
+    const auto deadline = begin + generator->GetReadinessTimeout();
+
+    auto interval = MinInterval;
+    auto stableSince = begin;
+    size_t names = 0;
+    size_t objects = 0;
+
+    while (true)
+    {
+        const auto now = steady_clock::now();
+
+        if (NamesStore::Initialize() && ObjectsStore::Initialize())
+        {
+            const auto currentNames = NamesStore().GetNamesNum();
+            const auto currentObjects = ObjectsStore().GetObjectsNum();
+            if (currentNames != names || currentObjects != objects)
+            {
+                names = currentNames;
+                objects = currentObjects;
+                stableSince = now;
+                interval = MinInterval;
+            }
+            else if (names > 0 && objects > 0 && now - stableSince >= window)
+            {
+                LOGI("Ready after %lld ms with %zu names and %zu objects", (long long) duration_cast<milliseconds>(now - begin).count(), names, objects);
+                return true;
+            }
+        }
+
+        const auto populated = names > 0 && objects > 0;
+        if (now >= deadline)
+        {
+            if (populated)
+            {
+                LOGW("The number of objects is still changing after %lld ms, generating anyway", (long long) duration_cast<milliseconds>(now - begin).count());
+                return true;
+            }
+            return false;
+        }
+
+        //do not sleep past the end of the window
+        auto sleep = interval;
+        if (populated)
+        {
+            sleep = std::max(milliseconds(1), std::min(sleep, duration_cast<milliseconds>(stableSince + window - now)));
+        }
+        std::this_thread::sleep_for(sleep);
+
+        interval = std::min(interval * 2, MaxInterval);
+    }
+}
+
+void *main_thread(void *) { 
+
+    if (!WaitForReadiness())
+    {
+        LOGE("The names and objects stores are still empty");
+        return 0;
+    }
+
+    if (!InitializeGenerator())
+    {
+        return 0;
+    }
+   
+    std::string outputDirectory = generator->GetOutputDirectory(pkgName);
+    
+    #if defined(__LP64__)
+    outputDirectory += "/" + generator->GetGameNameShort() + "_(v" + generator->GetGameVersion() + ")_64Bit";
+    #else
+    outputDirectory += "/" + generator->GetGameNameShort() + "_(v" + generator->GetGameVersion() + ")_32Bit";
+    #endif
+
+    if (generator->ShouldSaveSnapshot())
+    {
+        mkdir(outputDirectory.c_str(), 0777);
+
+        if (!SnapshotFile::Save(outputDirectory))
+        {
+            LOGE("SnapshotFile::Save failed");
+        }
+    }
+
+    Generate(outputDirectory);
 
     LOGE("Finished!");
     return 0;
@@ -276,4 +577,6 @@ void __attribute__ ((visibility ("default"))) OnLoad()
 }
 }
 
+#endif
+
 //Telegram: @vipsourcecode
\ No newline at end of file
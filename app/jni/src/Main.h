@@ -15,5 +15,7 @@ static std::string gameVersion = "3.0.0";
 static std::string gameShortName = "PUBGM";
 static std::string gameFullName = "PUBG";
 
+bool InitializeGenerator();
+void Generate(const std::string& outputDirectory);
 
 #endif
@@ -0,0 +1,103 @@
+#include "Manifest.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+
+#include "tinyformat.h"
+#include "OutputWriter.hpp"
+
+namespace
+{
+	/// <summary>Must be increased whenever the rendering of the generated files changes.</summary>
+	constexpr int ManifestVersion = 5;
+}
+
+Manifest::Manifest(std::string _buildId, uint64_t _configHash)
+	: buildId(std::move(_buildId)),
+	  configHash(_configHash)
+{
+}
+
+Manifest Manifest::Load(const std::string& path)
+{
+	std::ifstream is(path + "/" + FileName);
+	if (!is)
+	{
+		return Manifest();
+	}
+
+	Manifest manifest;
+
+	std::string line;
+	while (std::getline(is, line))
+	{
+		std::istringstream ls(line);
+
+		std::string key;
+		ls >> key;
+		if (key == "version")
+		{
+			int version = 0;
+			ls >> version;
+			if (version != ManifestVersion)
+			{
+				return Manifest();
+			}
+		}
+		else if (key == "build-id")
+		{
+			ls >> manifest.buildId;
+			if (manifest.buildId == "-")
+			{
+				manifest.buildId.clear();
+			}
+		}
+		else if (key == "config")
+		{
+			ls >> std::hex >> manifest.configHash;
+		}
+		else if (key == "package")
+		{
+			uint64_t hash;
+			std::string name;
+			if (ls >> std::hex >> hash >> name)
+			{
+				manifest.packages[name] = hash;
+			}
+		}
+	}
+
+	return manifest;
+}
+
+void Manifest::Save(const std::string& path) const
+{
+	std::ostringstream os;
+
+	os << "version " << ManifestVersion << "\n";
+	os << "build-id " << (buildId.empty() ? "-" : buildId) << "\n";
+	os << tfm::format("config %016X\n", configHash);
+
+	//sorted to keep the file stable
+	std::vector<std::pair<std::string, uint64_t>> sorted(std::begin(packages), std::end(packages));
+	std::sort(std::begin(sorted), std::end(sorted));
+	for (auto&& package : sorted)
+	{
+		os << tfm::format("package %016X %s\n", package.second, package.first);
+	}
+
+	OutputWriter::Write(path + "/" + FileName, os.str());
+}
+
+bool Manifest::HasPackage(const std::string& name, uint64_t hash) const
+{
+	const auto it = packages.find(name);
+	return it != std::end(packages) && it->second == hash;
+}
+
+void Manifest::AddPackage(const std::string& name, uint64_t hash)
+{
+	packages[name] = hash;
+}
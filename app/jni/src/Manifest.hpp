@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+/// <summary>
+/// Records what the files in the output directory were generated from: the build-id of the game library,
+/// the generator configuration and a hash of the types of every package. A package whose hash did not change
+/// since the last run does not need to be rendered and written again.
+/// </summary>
+class Manifest
+{
+public:
+	/// <summary>The name of the manifest file in the output directory.</summary>
+	static constexpr const char* FileName = "SDK.manifest";
+
+	/// <summary>Constructor.</summary>
+	/// <param name="buildId">The build-id of the game library (hex encoded), empty if unknown.</param>
+	/// <param name="configHash">The hash of the generator configuration.</param>
+	Manifest(std::string buildId = std::string(), uint64_t configHash = 0);
+
+	/// <summary>Loads the manifest of a previous run.</summary>
+	/// <param name="path">The output directory.</param>
+	/// <returns>The manifest, which contains no packages if it does not exist or is invalid.</returns>
+	static Manifest Load(const std::string& path);
+
+	/// <summary>Saves the manifest into the output directory.</summary>
+	/// <param name="path">The output directory.</param>
+	void Save(const std::string& path) const;
+
+	const std::string& GetBuildId() const { return buildId; }
+
+	uint64_t GetConfigHash() const { return configHash; }
+
+	/// <summary>Checks if the files of the package were generated from types with the given hash.</summary>
+	/// <param name="name">The name of the package.</param>
+	/// <param name="hash">The hash of the types of the package.</param>
+	/// <returns>true if the package is unchanged.</returns>
+	bool HasPackage(const std::string& name, uint64_t hash) const;
+
+	/// <summary>Records the hash of the package.</summary>
+	/// <param name="name">The name of the package.</param>
+	/// <param name="hash">The hash of the types of the package.</param>
+	void AddPackage(const std::string& name, uint64_t hash);
+
+private:
+	std::string buildId;
+	uint64_t configHash;
+	std::unordered_map<std::string, uint64_t> packages;
+};
@@ -0,0 +1,317 @@
+#include "MemoryReader.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+
+#include <unistd.h>
+#include <sys/uio.h>
+
+#include "Tools.h"
+
+constexpr size_t MemoryReader::PageSize;
+
+MemoryReader::MemoryReader(pid_t _pid, size_t _cachePages)
+	: pid(_pid != 0 ? _pid : getpid()),
+	  cachePages(_cachePages)
+{
+	const auto iovMax = sysconf(_SC_IOV_MAX);
+	maxIovecs = iovMax > 0 ? static_cast<size_t>(iovMax) : IOV_MAX;
+
+	memset(&stats, 0, sizeof(stats));
+}
+
+size_t MemoryReader::Queue(uintptr_t address, void* destination, size_t length)
+{
+	requests.push_back({ address, destination, length });
+
+	return requests.size() - 1;
+}
+
+size_t MemoryReader::Flush()
+{
+	stats.Reads += requests.size();
+
+	results.assign(requests.size(), false);
+
+	//reads which lie in cached pages need no call
+	std::vector<size_t> pending;
+	pending.reserve(requests.size());
+	for (auto i = 0u; i < requests.size(); ++i)
+	{
+		const auto& request = requests[i];
+		if (request.Length == 0)
+		{
+			results[i] = true;
+			continue;
+		}
+		if (CopyFromCache(request.Address, request.Destination, request.Length))
+		{
+			++stats.CacheHits;
+			results[i] = true;
+			continue;
+		}
+		pending.push_back(i);
+	}
+
+	std::sort(std::begin(pending), std::end(pending), [&](size_t lhs, size_t rhs)
+	{
+		return requests[lhs].Address < requests[rhs].Address;
+	});
+
+	//merge overlapping and adjacent ranges
+	std::vector<Span> spans;
+	std::vector<size_t> requestSpans(requests.size());
+	size_t size = 0;
+	for (auto i : pending)
+	{
+		const auto& request = requests[i];
+		const auto end = request.Address + request.Length;
+		if (!spans.empty() && request.Address <= spans.back().Address + spans.back().Length)
+		{
+			auto& span = spans.back();
+			if (end > span.Address + span.Length)
+			{
+				size += end - (span.Address + span.Length);
+				span.Length = end - span.Address;
+			}
+		}
+		else
+		{
+			spans.push_back({ request.Address, request.Length, size, false });
+			size += request.Length;
+		}
+		requestSpans[i] = spans.size() - 1;
+	}
+
+	std::vector<uint8_t> buffer(size);
+	ReadSpans(spans, buffer.data());
+
+	//a merged span fails as a whole if one of its pages is not readable, its reads are retried alone
+	std::vector<size_t> retries;
+	std::vector<Span> retrySpans;
+	size_t retrySize = 0;
+	for (auto i : pending)
+	{
+		const auto& request = requests[i];
+		const auto& span = spans[requestSpans[i]];
+		if (span.Read)
+		{
+			memcpy(request.Destination, buffer.data() + span.Offset + (request.Address - span.Address), request.Length);
+			results[i] = true;
+		}
+		else if (span.Length != request.Length)
+		{
+			retries.push_back(i);
+			retrySpans.push_back({ request.Address, request.Length, retrySize, false });
+			retrySize += request.Length;
+		}
+	}
+
+	if (!retries.empty())
+	{
+		buffer.resize(retrySize);
+		ReadSpans(retrySpans, buffer.data());
+
+		for (auto i = 0u; i < retries.size(); ++i)
+		{
+			if (retrySpans[i].Read)
+			{
+				const auto& request = requests[retries[i]];
+				memcpy(request.Destination, buffer.data() + retrySpans[i].Offset, request.Length);
+				results[retries[i]] = true;
+			}
+		}
+	}
+
+	requests.clear();
+
+	return static_cast<size_t>(std::count(std::begin(results), std::end(results), false));
+}
+
+bool MemoryReader::IsRead(size_t id) const
+{
+	return id < results.size() && results[id];
+}
+
+bool MemoryReader::ReadCached(uintptr_t address, void* destination, size_t length)
+{
+	++stats.Reads;
+
+	if (length == 0)
+	{
+		return true;
+	}
+
+	if (CopyFromCache(address, destination, length))
+	{
+		++stats.CacheHits;
+		return true;
+	}
+
+	if (cachePages != 0)
+	{
+		++stats.CacheMisses;
+
+		if (LoadPages(address, length))
+		{
+			return CopyFromCache(address, destination, length);
+		}
+	}
+
+	//the range does not fit into the cache or a page of it is not readable
+	std::vector<Span> spans{ { address, length, 0, false } };
+	ReadSpans(spans, static_cast<uint8_t*>(destination));
+	return spans[0].Read;
+}
+
+void MemoryReader::InvalidateCache()
+{
+	cache.clear();
+}
+
+void MemoryReader::ReadSpans(std::vector<Span>& spans, uint8_t* buffer)
+{
+	std::vector<iovec> local;
+	std::vector<iovec> remote;
+
+	size_t next = 0;
+	while (next < spans.size())
+	{
+		const auto first = next;
+		const auto last = std::min(spans.size(), first + maxIovecs);
+
+		local.clear();
+		remote.clear();
+		for (auto i = first; i < last; ++i)
+		{
+			local.push_back({ buffer + spans[i].Offset, spans[i].Length });
+			remote.push_back({ reinterpret_cast<void*>(spans[i].Address), spans[i].Length });
+		}
+
+		++stats.Calls;
+		const auto transferred = Tools::PVM_ReadV(pid, local.data(), local.size(), remote.data(), remote.size());
+		if (transferred < 0)
+		{
+			if (errno != EFAULT)
+			{
+				//the process is gone or can not be read, no span can succeed
+				return;
+			}
+
+			//the first range is not readable
+			next = first + 1;
+			continue;
+		}
+
+		stats.Bytes += transferred;
+
+		//the transfer stops at the first range which is not completely readable
+		auto remaining = static_cast<size_t>(transferred);
+		next = last;
+		for (auto i = first; i < last; ++i)
+		{
+			if (remaining < spans[i].Length)
+			{
+				next = i + 1;
+				break;
+			}
+			spans[i].Read = true;
+			remaining -= spans[i].Length;
+		}
+	}
+}
+
+bool MemoryReader::CopyFromCache(uintptr_t address, void* destination, size_t length)
+{
+	if (cache.empty())
+	{
+		return false;
+	}
+
+	const auto firstPage = address / PageSize;
+	const auto lastPage = (address + length - 1) / PageSize;
+	for (auto page = firstPage; page <= lastPage; ++page)
+	{
+		if (cache.find(page) == std::end(cache))
+		{
+			return false;
+		}
+	}
+
+	auto bytes = static_cast<uint8_t*>(destination);
+	for (auto page = firstPage; page <= lastPage; ++page)
+	{
+		auto& cached = cache[page];
+		cached.LastUse = ++useCounter;
+
+		const auto begin = std::max(address, page * PageSize);
+		const auto end = std::min(address + length, (page + 1) * PageSize);
+		memcpy(bytes, cached.Data.get() + (begin - page * PageSize), end - begin);
+		bytes += end - begin;
+	}
+
+	return true;
+}
+
+bool MemoryReader::LoadPages(uintptr_t address, size_t length)
+{
+	const auto firstPage = address / PageSize;
+	const auto lastPage = (address + length - 1) / PageSize;
+	if (lastPage - firstPage + 1 > cachePages)
+	{
+		return false;
+	}
+
+	//the cached pages of the range are used first so they are not evicted
+	std::vector<uintptr_t> missing;
+	for (auto page = firstPage; page <= lastPage; ++page)
+	{
+		const auto it = cache.find(page);
+		if (it != std::end(cache))
+		{
+			it->second.LastUse = ++useCounter;
+		}
+		else
+		{
+			missing.push_back(page);
+		}
+	}
+
+	std::vector<Span> spans;
+	for (auto i = 0u; i < missing.size(); ++i)
+	{
+		spans.push_back({ missing[i] * PageSize, PageSize, i * PageSize, false });
+	}
+
+	std::vector<uint8_t> buffer(spans.size() * PageSize);
+	ReadSpans(spans, buffer.data());
+
+	auto success = true;
+	for (auto i = 0u; i < missing.size(); ++i)
+	{
+		if (!spans[i].Read)
+		{
+			success = false;
+			continue;
+		}
+
+		if (cache.size() >= cachePages)
+		{
+			const auto lru = std::min_element(std::begin(cache), std::end(cache), [](const auto& lhs, const auto& rhs)
+			{
+				return lhs.second.LastUse < rhs.second.LastUse;
+			});
+			cache.erase(lru);
+		}
+
+		CachedPage cached;
+		cached.Data = std::make_unique<uint8_t[]>(PageSize);
+		cached.LastUse = ++useCounter;
+		memcpy(cached.Data.get(), buffer.data() + i * PageSize, PageSize);
+		cache.emplace(missing[i], std::move(cached));
+	}
+
+	return success;
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/types.h>
+
+/// <summary>
+/// Reads the memory of a process with process_vm_readv in batches.
+/// Callers queue many reads, <see cref="Flush" /> merges overlapping and adjacent ranges and submits them in as few calls
+/// as possible (up to IOV_MAX ranges per call). Reads through <see cref="ReadCached" /> go through a small page cache
+/// which absorbs repeated reads of hot memory like the classes and structs; queued reads which lie completely in cached
+/// pages are served from the cache as well.
+/// </summary>
+class MemoryReader
+{
+public:
+	/// <summary>The granularity of the cache.</summary>
+	static constexpr size_t PageSize = 4096;
+
+	struct Stats
+	{
+		/// <summary>The number of queued and cached reads.</summary>
+		size_t Reads;
+		/// <summary>The number of process_vm_readv calls.</summary>
+		size_t Calls;
+		/// <summary>The number of bytes transferred by process_vm_readv.</summary>
+		size_t Bytes;
+		size_t CacheHits;
+		size_t CacheMisses;
+	};
+
+	/// <param name="pid">The process to read, the own process if it is 0.</param>
+	/// <param name="cachePages">The number of pages the cache holds, 0 disables the cache.</param>
+	explicit MemoryReader(pid_t pid = 0, size_t cachePages = 64);
+
+	/// <summary>Queues a read of [address, address + length) into the destination.</summary>
+	/// <returns>The id of the read for <see cref="IsRead" />.</returns>
+	size_t Queue(uintptr_t address, void* destination, size_t length);
+
+	/// <summary>Executes all queued reads, their results can be checked with <see cref="IsRead" /> until the next flush.</summary>
+	/// <returns>The number of reads which failed.</returns>
+	size_t Flush();
+
+	/// <summary>Checks if a read of the last <see cref="Flush" /> succeeded.</summary>
+	bool IsRead(size_t id) const;
+
+	/// <summary>Reads [address, address + length) through the page cache.</summary>
+	/// <returns>true if it succeeds, false if a page is not readable.</returns>
+	bool ReadCached(uintptr_t address, void* destination, size_t length);
+
+	/// <summary>Drops all cached pages, must be called when the memory of the process may have changed.</summary>
+	void InvalidateCache();
+
+	const Stats& GetStats() const
+	{
+		return stats;
+	}
+
+private:
+	struct Request
+	{
+		uintptr_t Address;
+		void* Destination;
+		size_t Length;
+	};
+
+	/// <summary>Merged requests, read into the staging buffer at Offset.</summary>
+	struct Span
+	{
+		uintptr_t Address;
+		size_t Length;
+		size_t Offset;
+		bool Read;
+	};
+
+	struct CachedPage
+	{
+		std::unique_ptr<uint8_t[]> Data;
+		uint64_t LastUse;
+	};
+
+	/// <summary>Reads the spans with as few calls as possible, the read spans are marked.</summary>
+	void ReadSpans(std::vector<Span>& spans, uint8_t* buffer);
+
+	/// <summary>Copies a range which lies completely in cached pages.</summary>
+	bool CopyFromCache(uintptr_t address, void* destination, size_t length);
+
+	/// <summary>Reads the missing pages of a range into the cache.</summary>
+	bool LoadPages(uintptr_t address, size_t length);
+
+	pid_t pid;
+	size_t maxIovecs;
+
+	std::vector<Request> requests;
+	std::vector<bool> results;
+
+	size_t cachePages;
+	uint64_t useCounter = 0;
+	std::unordered_map<uintptr_t, CachedPage> cache;
+
+	Stats stats;
+};
@@ -0,0 +1,359 @@
+#include "ModuleMap.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+constexpr int32_t ModuleMap::NoModule;
+constexpr int ModuleMap::MinRefreshInterval;
+
+namespace
+{
+	struct MapsData
+	{
+		std::shared_mutex Mutex;
+		bool Parsed = false;
+
+		/// <summary>Increased by every parse, a miss does not parse again if another thread parsed in the meantime.</summary>
+		uint64_t Generation = 0;
+		std::chrono::steady_clock::time_point LastParse;
+
+		std::vector<ModuleMap::Segment> Segments;
+		std::vector<ModuleMap::Module> Modules;
+
+		/// <summary>The first module of every file name.</summary>
+		std::unordered_map<std::string, int32_t> ModuleIds;
+	};
+
+	MapsData maps;
+
+	bool ReadFile(const char* path, std::string& content)
+	{
+		const auto fd = open(path, O_RDONLY | O_CLOEXEC);
+		if (fd < 0)
+		{
+			return false;
+		}
+
+		//the size of a proc file is unknown, it is read until the end
+		char buffer[16384];
+		while (true)
+		{
+			const auto count = read(fd, buffer, sizeof(buffer));
+			if (count < 0)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+				close(fd);
+				return false;
+			}
+			if (count == 0)
+			{
+				break;
+			}
+			content.append(buffer, count);
+		}
+
+		close(fd);
+		return true;
+	}
+
+	const char* ParseHex(const char* p, const char* end, uint64_t& value)
+	{
+		value = 0;
+		for (; p < end; ++p)
+		{
+			const auto c = *p;
+			if (c >= '0' && c <= '9') value = value << 4 | (c - '0');
+			else if (c >= 'a' && c <= 'f') value = value << 4 | (c - 'a' + 10);
+			else if (c >= 'A' && c <= 'F') value = value << 4 | (c - 'A' + 10);
+			else break;
+		}
+		return p;
+	}
+
+	const char* SkipField(const char* p, const char* end)
+	{
+		while (p < end && *p != ' ') ++p;
+		while (p < end && *p == ' ') ++p;
+		return p;
+	}
+
+	/// <summary>
+	/// Parses one line: "begin-end perms offset dev inode path", the path is optional and may contain spaces.
+	/// </summary>
+	bool ParseLine(const char* p, const char* end, ModuleMap::Segment& segment, const char*& path)
+	{
+		uint64_t begin, segmentEnd, offset;
+
+		p = ParseHex(p, end, begin);
+		if (p == end || *p++ != '-')
+		{
+			return false;
+		}
+		p = ParseHex(p, end, segmentEnd);
+		if (end - p < 6 || *p++ != ' ')
+		{
+			return false;
+		}
+
+		segment.Protection = (p[0] == 'r' ? PROT_READ : 0) | (p[1] == 'w' ? PROT_WRITE : 0) | (p[2] == 'x' ? PROT_EXEC : 0);
+		p = SkipField(p, end);
+
+		p = ParseHex(p, end, offset);
+		while (p < end && *p == ' ') ++p;
+
+		//device and inode
+		p = SkipField(p, end);
+		p = SkipField(p, end);
+
+		segment.Begin = static_cast<uintptr_t>(begin);
+		segment.End = static_cast<uintptr_t>(segmentEnd);
+		segment.Offset = offset;
+		segment.Module = ModuleMap::NoModule;
+		path = p;
+
+		return segment.Begin < segment.End;
+	}
+
+	/// <summary>Parses the maps file into the tables, the caller holds the exclusive lock.</summary>
+	bool Parse()
+	{
+		std::string content;
+		if (!ReadFile("/proc/self/maps", content))
+		{
+			return false;
+		}
+
+		maps.Segments.clear();
+		maps.Modules.clear();
+		maps.ModuleIds.clear();
+
+		std::unordered_map<std::string, int32_t> pathIds;
+
+		const auto end = content.data() + content.size();
+		for (auto p = static_cast<const char*>(content.data()); p < end; )
+		{
+			auto lineEnd = static_cast<const char*>(memchr(p, '\n', end - p));
+			if (lineEnd == nullptr)
+			{
+				lineEnd = end;
+			}
+
+			ModuleMap::Segment segment;
+			const char* pathBegin;
+			if (ParseLine(p, lineEnd, segment, pathBegin))
+			{
+				//only file mappings form modules, [stack], [anon:...] and friends stay anonymous
+				if (pathBegin < lineEnd && *pathBegin == '/')
+				{
+					std::string path(pathBegin, lineEnd);
+
+					auto it = pathIds.find(path);
+					if (it == std::end(pathIds))
+					{
+						ModuleMap::Module module;
+						module.Name = path.substr(path.rfind('/') + 1);
+						module.Path = path;
+						module.Begin = segment.Begin;
+						module.End = segment.End;
+
+						const auto id = static_cast<int32_t>(maps.Modules.size());
+						maps.ModuleIds.emplace(module.Name, id);
+						maps.Modules.push_back(std::move(module));
+						it = pathIds.emplace(std::move(path), id).first;
+					}
+
+					segment.Module = it->second;
+
+					auto& module = maps.Modules[it->second];
+					module.Begin = std::min(module.Begin, segment.Begin);
+					module.End = std::max(module.End, segment.End);
+					module.Segments.push_back(segment);
+				}
+
+				maps.Segments.push_back(segment);
+			}
+
+			p = lineEnd + 1;
+		}
+
+		//the kernel lists the mappings in address order already
+		if (!std::is_sorted(std::begin(maps.Segments), std::end(maps.Segments), [](const auto& lhs, const auto& rhs) { return lhs.Begin < rhs.Begin; }))
+		{
+			std::sort(std::begin(maps.Segments), std::end(maps.Segments), [](const auto& lhs, const auto& rhs) { return lhs.Begin < rhs.Begin; });
+		}
+
+		maps.Parsed = true;
+		++maps.Generation;
+		maps.LastParse = std::chrono::steady_clock::now();
+
+		return true;
+	}
+
+	/// <summary>
+	/// Runs the query on the cached tables and once more if it misses, after a refresh unless the tables are younger than
+	/// <see cref="ModuleMap::MinRefreshInterval" />, got refreshed by another thread meanwhile or <paramref name="refreshOnMiss" /> is false.
+	/// </summary>
+	template<typename Fn>
+	bool Query(bool refreshOnMiss, Fn&& query)
+	{
+		uint64_t generation;
+		{
+			std::shared_lock<std::shared_mutex> lock(maps.Mutex);
+			if (maps.Parsed && query())
+			{
+				return true;
+			}
+			if (maps.Parsed && !refreshOnMiss)
+			{
+				return false;
+			}
+			generation = maps.Generation;
+		}
+
+		std::unique_lock<std::shared_mutex> lock(maps.Mutex);
+		if (!maps.Parsed
+			|| (maps.Generation == generation && std::chrono::steady_clock::now() - maps.LastParse >= std::chrono::milliseconds(ModuleMap::MinRefreshInterval)))
+		{
+			Parse();
+		}
+		return query();
+	}
+
+	const ModuleMap::Module* FindModule(const std::string& name)
+	{
+		const auto it = maps.ModuleIds.find(name);
+		return it != std::end(maps.ModuleIds) ? &maps.Modules[it->second] : nullptr;
+	}
+
+	/// <summary>Finds the segment an address lies in by binary search.</summary>
+	std::vector<ModuleMap::Segment>::const_iterator FindSegmentIterator(uintptr_t address)
+	{
+		auto it = std::upper_bound(std::begin(maps.Segments), std::end(maps.Segments), address, [](uintptr_t value, const ModuleMap::Segment& segment)
+		{
+			return value < segment.Begin;
+		});
+		if (it == std::begin(maps.Segments))
+		{
+			return std::end(maps.Segments);
+		}
+		--it;
+		return address < it->End ? it : std::end(maps.Segments);
+	}
+}
+
+bool ModuleMap::Refresh()
+{
+	std::unique_lock<std::shared_mutex> lock(maps.Mutex);
+	return Parse();
+}
+
+bool ModuleMap::GetModule(const std::string& name, Module& module)
+{
+	return Query(true, [&]()
+	{
+		const auto found = FindModule(name);
+		if (found == nullptr)
+		{
+			return false;
+		}
+		module = *found;
+		return true;
+	});
+}
+
+uintptr_t ModuleMap::GetBaseAddress(const std::string& name)
+{
+	uintptr_t address = 0;
+	Query(true, [&]()
+	{
+		const auto module = FindModule(name);
+		address = module != nullptr ? module->Begin : 0;
+		return module != nullptr;
+	});
+	return address;
+}
+
+uintptr_t ModuleMap::GetEndAddress(const std::string& name)
+{
+	uintptr_t address = 0;
+	Query(true, [&]()
+	{
+		const auto module = FindModule(name);
+		address = module != nullptr ? module->End : 0;
+		return module != nullptr;
+	});
+	return address;
+}
+
+bool ModuleMap::Contains(const std::string& name, uintptr_t address)
+{
+	auto contains = false;
+	//only an unknown module or an unmapped address is a miss
+	Query(true, [&]()
+	{
+		const auto module = FindModule(name);
+		const auto it = FindSegmentIterator(address);
+		if (module == nullptr || it == std::end(maps.Segments))
+		{
+			return false;
+		}
+		contains = it->Module != NoModule && maps.Modules[it->Module].Name == name;
+		return true;
+	});
+	return contains;
+}
+
+bool ModuleMap::FindSegment(uintptr_t address, Segment& segment, bool refreshOnMiss)
+{
+	return Query(refreshOnMiss, [&]()
+	{
+		const auto it = FindSegmentIterator(address);
+		if (it == std::end(maps.Segments))
+		{
+			return false;
+		}
+		segment = *it;
+		return true;
+	});
+}
+
+bool ModuleMap::GetProtection(uintptr_t address, size_t length, int required, int& protection, bool refreshOnMiss)
+{
+	if (length == 0 || address + length < address)
+	{
+		return false;
+	}
+
+	const auto end = address + length;
+	//only an unmapped byte is a miss, the protection of a mapped range is answered from the cache
+	const auto mapped = Query(refreshOnMiss, [&]()
+	{
+		auto it = FindSegmentIterator(address);
+
+		//the range may span adjacent segments with different protections
+		protection = PROT_READ | PROT_WRITE | PROT_EXEC;
+		for (auto covered = address; it != std::end(maps.Segments) && it->Begin <= covered; ++it)
+		{
+			protection &= it->Protection;
+			covered = it->End;
+			if (covered >= end)
+			{
+				return true;
+			}
+		}
+		return false;
+	});
+	return mapped && (protection & required) == required;
+}
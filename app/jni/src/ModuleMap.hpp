@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// A cache of the mappings of /proc/self/maps. The file is parsed in one pass into a table of segments sorted by address
+/// and a table of the loaded modules, so the address and module queries are binary searches without any syscall.
+/// The cache is refreshed on demand and when a query misses, at most once per <see cref="MinRefreshInterval" /> for all
+/// misses together; a hit is not rechecked, a mapping which was removed after the last refresh is still reported.
+/// All methods are thread safe.
+/// </summary>
+class ModuleMap
+{
+public:
+	static constexpr int32_t NoModule = -1;
+
+	/// <summary>The minimum time between two refreshes caused by misses, in milliseconds.</summary>
+	static constexpr int MinRefreshInterval = 100;
+
+	/// <summary>One line of the maps file.</summary>
+	struct Segment
+	{
+		uintptr_t Begin;
+		uintptr_t End;
+		/// <summary>The PROT_* flags of the mapping.</summary>
+		int Protection;
+		/// <summary>The offset of the mapping in its file.</summary>
+		uint64_t Offset;
+		/// <summary>The index of the module the mapping belongs to, <see cref="NoModule" /> for anonymous mappings.</summary>
+		int32_t Module;
+	};
+
+	/// <summary>A mapped file with all of its segments.</summary>
+	struct Module
+	{
+		/// <summary>The file name without the directory.</summary>
+		std::string Name;
+		std::string Path;
+		/// <summary>The start of the first segment.</summary>
+		uintptr_t Begin;
+		/// <summary>The end of the last segment.</summary>
+		uintptr_t End;
+		std::vector<Segment> Segments;
+	};
+
+	/// <summary>Parses /proc/self/maps again.</summary>
+	/// <returns>true if it succeeds, false if the file can not be read.</returns>
+	static bool Refresh();
+
+	/// <summary>Gets a loaded module by its file name.</summary>
+	/// <param name="name">The file name, e.g. libUE4.so.</param>
+	/// <param name="module">[out] A copy of the module.</param>
+	/// <returns>true if the module is loaded, false if not.</returns>
+	static bool GetModule(const std::string& name, Module& module);
+
+	/// <summary>Gets the start of the first segment of a module.</summary>
+	/// <returns>The address, 0 if the module is not loaded.</returns>
+	static uintptr_t GetBaseAddress(const std::string& name);
+
+	/// <summary>Gets the end of the last segment of a module.</summary>
+	/// <returns>The address, 0 if the module is not loaded.</returns>
+	static uintptr_t GetEndAddress(const std::string& name);
+
+	/// <summary>Checks if an address lies in a segment of a module.</summary>
+	static bool Contains(const std::string& name, uintptr_t address);
+
+	/// <summary>Finds the segment an address lies in.</summary>
+	/// <param name="address">The address.</param>
+	/// <param name="segment">[out] A copy of the segment.</param>
+	/// <param name="refreshOnMiss">false if an unmapped address is expected and must not refresh the cache.</param>
+	/// <returns>true if the address is mapped, false if not.</returns>
+	static bool FindSegment(uintptr_t address, Segment& segment, bool refreshOnMiss = true);
+
+	/// <summary>
+	/// Gets the PROT_* flags all bytes of [address, address + length) have, the range may span adjacent segments.
+	/// Only an unmapped byte is a miss, a mapped range which lacks a required flag does not refresh the cache.
+	/// </summary>
+	/// <param name="address">The start of the range.</param>
+	/// <param name="length">The length of the range.</param>
+	/// <param name="required">The flags the range must have.</param>
+	/// <param name="protection">[out] The flags.</param>
+	/// <param name="refreshOnMiss">false if an unmapped range is expected and must not refresh the cache.</param>
+	/// <returns>true if the range is mapped with the required flags, false if not.</returns>
+	static bool GetProtection(uintptr_t address, size_t length, int required, int& protection, bool refreshOnMiss = true);
+};
@@ -6,7 +6,8 @@
 
 std::string MakeValidName(std::string&& name)
 {
-	std::string valid(name);
+	//the name is fixed in place, so a reused buffer keeps its capacity
+	auto& valid = name;
 
 	for (auto i = 0u; i < name.length(); ++i)
 	{
@@ -38,11 +39,11 @@ std::string MakeValidName(std::string&& name)
 	{
 		if (std::isdigit(valid[0]))
 		{
-			valid = '_' + valid;
+			valid.insert(0, 1, '_');
 		}
 	}
 
-	return valid;
+	return std::move(valid);
 }
 
 std::string SimplifyEnumName(std::string&& name)
@@ -60,7 +61,7 @@ template<typename T>
 std::string MakeUniqueCppNameImpl(const T& t)
 {
 	std::string name;
-	if (ObjectsStore().CountObjects<T>(t.GetName()) > 1)
+	if (ObjectsStore().CountObjects<T>(t) > 1)
 	{
 		name += MakeValidName(t.GetOuter().GetName()) + "_";
 	}
@@ -85,7 +86,7 @@ std::string MakeUniqueCppName(const UEEnum& e)
 std::string MakeUniqueCppName(const UEStruct& ss)
 {
 	std::string name;
-	if (ObjectsStore().CountObjects<UEStruct>(ss.GetName()) > 1)
+	if (ObjectsStore().CountObjects<UEStruct>(ss) > 1)
 	{
 		name += MakeValidName(ss.GetOuter().GetNameCPP()) + "_";
 	}
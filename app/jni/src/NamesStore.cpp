@@ -1,7 +1,14 @@
 //Telegram: @vipsourcecode
 #include "NamesStore.hpp"
 
+#include <cstring>
+
+#include <sys/mman.h>
+
 #include "EngineClasses.hpp"
+#include "IGenerator.hpp"
+#include "ModuleMap.hpp"
+#include "PatternScanner.hpp"
 #include "Tools.h"
 NamesIterator NamesStore::begin()
 {
@@ -79,80 +86,129 @@ UENameInfo NamesIterator::operator->() const
     return { index, store.GetById(index) };
 }
 
-class FNameEntry
-{
-public:
+TNameEntryArray* GNames = nullptr;
 
-    FNameEntry* HashNext;
-    __int32 Index;
-	union
+namespace
+{
+	/// <summary>All names decoded into one arena, indexed by the name id.</summary>
+	struct NameTable
 	{
-		char AnsiName[1024];
-		wchar_t WideName[1024];
+		std::vector<char> Data;
+		std::vector<uint32_t> Offsets;
+		std::vector<uint32_t> ShortOffsets;
 	};
 
-	const char* GetName() const
-	{
-		return AnsiName;
-	}
-};
+	NameTable table;
+}
 
-template<typename ElementType, int32_t MaxTotalElements, int32_t ElementsPerChunk>
-class TStaticIndirectArrayThreadSafeRead
+bool NamesStore::Initialize()
 {
-public:
-	int32_t Num() const
+	if (GNames == nullptr)
 	{
-		return NumElements;
-	}
+		//the signatures are scanned once, the accessor returns null until the engine created the names store
+		static uintptr_t getNames = 0;
+		if (getNames == 0)
+		{
+			extern IGenerator* generator;
+			const auto address = PatternScanner::Resolve("libUE4.so", generator->GetSignatures(), "GetNames");
+			int protection;
+			if (address == 0 || !ModuleMap::GetProtection(address, sizeof(uint32_t), PROT_READ | PROT_EXEC, protection))
+			{
+				return false;
+			}
+			getNames = address;
+		}
 
-	bool IsValidIndex(int32_t index) const
-	{
-		return index >= 0 && index < Num() && GetById(index) != nullptr;
+		const auto names = (TNameEntryArray*) (((uintptr_t (*)())getNames)());
+		if (!Tools::IsPtrValid(names, sizeof(TNameEntryArray)))
+		{
+			return false;
+		}
+
+		GNames = names;
 	}
+	return true;
+}
 
-	ElementType const* const& GetById(int32_t index) const
+bool NamesStore::Initialize(void* address)
+{
+	if (!Tools::IsPtrValid(address, sizeof(TNameEntryArray)))
 	{
-		return *GetItemPtr(index);
+		return false;
 	}
 
-private:
-	ElementType const* const* GetItemPtr(int32_t Index) const
+	GNames = static_cast<TNameEntryArray*>(address);
+
+	return true;
+}
+
+bool NamesStore::InitializeTable()
+{
+	const NamesStore store;
+	const auto count = store.GetNamesNum();
+
+	std::vector<const char*> entries(count, nullptr);
+	std::vector<uint32_t> lengths(count, 0);
+
+	size_t size = 0;
+	for (auto i = 0u; i < count; ++i)
 	{
-		int32_t ChunkIndex = Index / ElementsPerChunk;
-		int32_t WithinChunkIndex = Index % ElementsPerChunk;
-		ElementType** Chunk = Chunks[ChunkIndex];
-		return Chunk + WithinChunkIndex;
+		if (store.IsValid(i))
+		{
+			entries[i] = GNames->GetById(static_cast<int32_t>(i))->GetName();
+			lengths[i] = static_cast<uint32_t>(std::strlen(entries[i]));
+			size += lengths[i];
+		}
 	}
 
-	enum
+	table.Data.resize(size);
+	table.Offsets.resize(count + 1);
+	table.ShortOffsets.resize(count);
+
+	uint32_t offset = 0;
+	for (auto i = 0u; i < count; ++i)
 	{
-		ChunkTableSize = (MaxTotalElements + ElementsPerChunk - 1) / ElementsPerChunk
-	};
+		table.Offsets[i] = offset;
+		table.ShortOffsets[i] = offset;
 
-	ElementType** Chunks[ChunkTableSize];
-	__int32 NumElements;
-	__int32 NumChunks;
-};
+		if (entries[i] != nullptr)
+		{
+			std::memcpy(table.Data.data() + offset, entries[i], lengths[i]);
 
-using TNameEntryArray = TStaticIndirectArrayThreadSafeRead<FNameEntry, 2 * 1024 * 1024, 16384>;
+			const auto slash = static_cast<const char*>(memrchr(entries[i], '/', lengths[i]));
+			if (slash != nullptr)
+			{
+				table.ShortOffsets[i] = offset + static_cast<uint32_t>(slash - entries[i]) + 1;
+			}
 
-TNameEntryArray* GNames = nullptr;
+			offset += lengths[i];
+		}
+	}
+	table.Offsets[count] = offset;
 
-bool NamesStore::Initialize() {
-	    static bool blGNames = false;
-		if (!blGNames) {
-			auto g_UE4GNames = Tools::GetBaseAddress("libUE4.so");
-			while (!g_UE4GNames) {
-				g_UE4GNames = Tools::GetBaseAddress("libUE4.so");
-				sleep(1);
-			}
-			GNames = (TNameEntryArray *) (((uintptr_t (*)())(g_UE4GNames + 0x3E799F4))());
-			blGNames = true;
-	  }
 	return true;
 }
 
+void NamesStore::GetMemoryRanges(std::vector<std::pair<const void*, size_t>>& ranges)
+{
+	ranges.emplace_back(GNames, sizeof(TNameEntryArray));
+
+	for (auto i = 0; i < GNames->GetChunksNum(); ++i)
+	{
+		ranges.emplace_back(GNames->GetChunk(i), TNameEntryArray::GetElementsPerChunk() * sizeof(FNameEntry*));
+	}
+
+	const NamesStore store;
+	for (auto i = 0u; i < store.GetNamesNum(); ++i)
+	{
+		if (store.IsValid(i))
+		{
+			const auto entry = GNames->GetById(static_cast<int32_t>(i));
+			ranges.emplace_back(entry, offsetof(FNameEntry, AnsiName) + std::strlen(entry->GetName()) + 1);
+		}
+	}
+}
+
 void* NamesStore::GetAddress()
 {
 	return GNames;
@@ -170,8 +226,30 @@ bool NamesStore::IsValid(size_t id) const
 
 std::string NamesStore::GetById(size_t id) const
 {
+	return std::string(GetViewById(id));
+}
+
+std::string_view NamesStore::GetViewById(size_t id) const
+{
+	if (id < table.ShortOffsets.size())
+	{
+		return std::string_view(table.Data.data() + table.Offsets[id], table.Offsets[id + 1] - table.Offsets[id]);
+	}
+
 	return GNames->GetById(static_cast<int32_t>(id))->GetName();
 }
 
+std::string_view NamesStore::GetShortViewById(size_t id) const
+{
+	if (id < table.ShortOffsets.size())
+	{
+		return std::string_view(table.Data.data() + table.ShortOffsets[id], table.Offsets[id + 1] - table.ShortOffsets[id]);
+	}
+
+	const auto name = GetViewById(id);
+	const auto pos = name.rfind('/');
+	return pos == std::string_view::npos ? name : name.substr(pos + 1);
+}
+
 
 //Telegram: @vipsourcecode
\ No newline at end of file
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <iterator>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 #include "UE4/GenericTypes.hpp"
 
@@ -15,11 +18,34 @@ class NamesStore
 public:
 
 	/// <summary>
-	/// Initializes this object.
+	/// Initializes this object with the accessor the "GetNames" signatures of the generator (<see cref="IGenerator::GetSignatures" />) resolve.
+	/// Does not wait, it can be called again until the engine created the names store.
 	/// </summary>
-	/// <returns>true if it succeeds, false if it fails.</returns>
+	/// <returns>true if it succeeds, false if libUE4.so is not loaded yet, no signature resolves or the names store does not exist yet.</returns>
 	static bool Initialize();
 
+	/// <summary>
+	/// Initializes this object with a known address of the global names store,
+	/// e.g. the one recorded in a snapshot file (<see cref="SnapshotFile" />).
+	/// </summary>
+	/// <param name="address">The address of the global names store.</param>
+	/// <returns>true if it succeeds, false if it fails.</returns>
+	static bool Initialize(void* address);
+
+	/// <summary>
+	/// Decodes every name once into one contiguous table.
+	/// Afterwards <see cref="GetViewById" /> and <see cref="GetShortViewById" /> answer without any allocation.
+	/// Names which get added after the table is built are read from the global names store.
+	/// </summary>
+	/// <returns>true if it succeeds, false if it fails.</returns>
+	static bool InitializeTable();
+
+	/// <summary>
+	/// Adds the memory the global names store consists of (the store, its chunks and every entry) to the ranges.
+	/// </summary>
+	/// <param name="ranges">[in,out] The address and size of every memory range.</param>
+	static void GetMemoryRanges(std::vector<std::pair<const void*, size_t>>& ranges);
+
 	/// <summary>Gets the address of the global names store.</summary>
 	/// <returns>The address of the global names store.</returns>
 	static void* GetAddress();
@@ -51,6 +77,20 @@ public:
 	/// <param name="id">The identifier.</param>
 	/// <returns>The name.</returns>
 	std::string GetById(size_t id) const;
+
+	/// <summary>
+	/// Gets a name by id without copying it.
+	/// </summary>
+	/// <param name="id">The identifier.</param>
+	/// <returns>The name.</returns>
+	std::string_view GetViewById(size_t id) const;
+
+	/// <summary>
+	/// Gets a name by id with the leading path (everything up to the last '/') stripped.
+	/// </summary>
+	/// <param name="id">The identifier.</param>
+	/// <returns>The name without path.</returns>
+	std::string_view GetShortViewById(size_t id) const;
 };
 
 struct UENameInfo
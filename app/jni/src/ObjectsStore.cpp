@@ -1,8 +1,74 @@
 #include "ObjectsStore.hpp"
 
+#include <array>
+#include <cassert>
+#include <string_view>
+
 #include "EngineClasses.hpp"
+#include "IGenerator.hpp"
+#include "PatternScanner.hpp"
+#include "ReflectionSnapshot.hpp"
 #include "Tools.h"
 
+namespace
+{
+    struct ObjectIndex
+    {
+        bool Initialized = false;
+
+        /// <summary>The full names of the objects if the reflection snapshot is not available.</summary>
+        std::vector<std::string> FullNames;
+
+        /// <summary>The first object of every full name.</summary>
+        std::unordered_map<std::string_view, UEObject> Objects;
+
+        /// <summary>The object of every slot when the index got built.</summary>
+        std::vector<void*> Slots;
+
+        /// <summary>The classes whose instances are counted by name.</summary>
+        std::array<UEClass, 3> CollisionKinds;
+
+        /// <summary>The number of instances of the collision kind per name (comparison index and number).</summary>
+        std::array<std::unordered_map<uint64_t, size_t>, 3> Collisions;
+    };
+
+    uint64_t MakeNameKey(const UEObject& obj)
+    {
+        const ReflectionSnapshot snapshot;
+        const auto row = obj.GetRow();
+        if (row != ReflectionSnapshot::NullRow)
+        {
+            return static_cast<uint64_t>(static_cast<uint32_t>(snapshot.GetNameIndex(row))) << 32 | static_cast<uint32_t>(snapshot.GetNameNumber(row));
+        }
+        const auto object = static_cast<const UObject*>(obj.GetAddress());
+        return static_cast<uint64_t>(static_cast<uint32_t>(object->NamePrivate.ComparisonIndex)) << 32 | static_cast<uint32_t>(object->NamePrivate.Number);
+    }
+
+    /// <summary>The full names of the classes in <see cref="ObjectIndex::CollisionKinds" />, UE4 has no constants.</summary>
+    const std::array<std::string_view, 3> CollisionKindNames = { std::string_view(), "Class CoreUObject.Enum", "Class CoreUObject.Struct" };
+
+    /// <summary>The bit of every collision kind the class or one of its super classes is.</summary>
+    uint8_t GetCollisionKinds(const UEClass& cls)
+    {
+        uint8_t kinds = 0;
+        std::string buffer;
+        for (auto super = cls; super.IsValid(); super = super.GetSuper().Cast<UEClass>())
+        {
+            const auto name = super.GetFullNameView(buffer);
+            for (auto kind = 0u; kind < CollisionKindNames.size(); ++kind)
+            {
+                if (!CollisionKindNames[kind].empty() && name == CollisionKindNames[kind])
+                {
+                    kinds |= 1 << kind;
+                }
+            }
+        }
+        return kinds;
+    }
+
+    ObjectIndex objectIndex;
+}
+
 ObjectsIterator ObjectsStore::begin()
 {
     return ObjectsIterator(*this, 0);
@@ -23,16 +89,77 @@ ObjectsIterator ObjectsStore::end() const
     return ObjectsIterator(*this);
 }
 
-UEClass ObjectsStore::FindClass(const std::string& name) const
+UEObject ObjectsStore::FindObject(const std::string& name) const
 {
+    if (objectIndex.Initialized)
+    {
+        const auto it = objectIndex.Objects.find(std::string_view(name));
+        if (it != std::end(objectIndex.Objects))
+        {
+            return it->second;
+        }
+
+        //only objects which were created after the index got built can still match
+        std::string buffer;
+        for (auto i = 0u; i < GetObjectsNum(); ++i)
+        {
+            const auto obj = GetById(i);
+            if (!obj.IsValid() || (i < objectIndex.Slots.size() && objectIndex.Slots[i] == obj.GetAddress()))
+            {
+                continue;
+            }
+
+            if (obj.GetFullNameView(buffer) == name)
+            {
+                return obj;
+            }
+        }
+        return UEObject(nullptr);
+    }
+
+    std::string buffer;
     for (auto obj : *this)
     {
-        if (obj.GetFullName() == name)
+        if (obj.GetFullNameView(buffer) == name)
         {
-            return obj.Cast<UEClass>();
+            return obj;
         }
     }
-    return UEClass(nullptr);
+    return UEObject(nullptr);
+}
+
+UEClass ObjectsStore::FindClass(const std::string& name) const
+{
+    return FindObject(name).Cast<UEClass>();
+}
+
+size_t ObjectsStore::CountObjects(const UEClass& cls, const UEObject& obj) const
+{
+    if (objectIndex.Initialized)
+    {
+        for (auto i = 0u; i < objectIndex.CollisionKinds.size(); ++i)
+        {
+            if (objectIndex.CollisionKinds[i].GetAddress() == cls.GetAddress())
+            {
+                const auto it = objectIndex.Collisions[i].find(MakeNameKey(obj));
+                return it != std::end(objectIndex.Collisions[i]) ? it->second : 0;
+            }
+        }
+    }
+
+    std::string nameBuffer;
+    const auto name = obj.GetNameView(nameBuffer);
+
+    std::string buffer;
+    size_t count = 0;
+    for (auto other : *this)
+    {
+        if (other.IsA(cls) && other.GetNameView(buffer) == name)
+        {
+            ++count;
+        }
+    }
+    return count;
 }
 
 ObjectsIterator::ObjectsIterator(const ObjectsStore& _store)
@@ -117,52 +244,41 @@ UEObject ObjectsIterator::operator->() const
     return operator*();
 }
 
-class FUObjectItem
-{
-public:
-	UObject* Object; //0x0000
-	__int32 Flags; //0x0008
-	__int32 ClusterIndex; //0x000C
-	__int32 SerialNumber; //0x0010
-    char pad1[0x4];
-};
+FUObjectArray* GUObjectArray = nullptr;
 
-class TUObjectArray
+bool ObjectsStore::Initialize()
 {
-public:
-	FUObjectItem* Objects;
-	int32_t MaxElements;
-	int32_t NumElements;
-};
+	if (GUObjectArray == nullptr)
+	{
+		extern IGenerator* generator;
+		const auto address = PatternScanner::Resolve("libUE4.so", generator->GetSignatures(), "GUObjectArray");
+		if (!Tools::IsPtrValid(reinterpret_cast<void*>(address), sizeof(FUObjectArray)))
+		{
+			return false;
+		}
 
-class FUObjectArray
-{
-public:
-	__int32 ObjFirstGCIndex; //0x0000
-	__int32 ObjLastNonGCIndex; //0x0004
-	__int32 MaxObjectsNotConsideredByGC; //0x0008
-	__int32 OpenForDisregardForGC; //0x000C
+		GUObjectArray = (FUObjectArray*) address;
+	}
+	return true;
+}
 
-	TUObjectArray ObjObjects; //0x0010
-};
+bool ObjectsStore::Initialize(void* address)
+{
+	if (!Tools::IsPtrValid(address, sizeof(FUObjectArray)))
+	{
+		return false;
+	}
 
-FUObjectArray* GUObjectArray = nullptr;
+	GUObjectArray = static_cast<FUObjectArray*>(address);
 
-bool ObjectsStore::Initialize()
-{
-	static bool blGNames = false;
-	if (!blGNames) {
-       auto UE4 = Tools::GetBaseAddress("libUE4.so");
-       while (!UE4) {
-           UE4 = Tools::GetBaseAddress("libUE4.so");
-           sleep(1);
-          }      
-        GUObjectArray = (FUObjectArray*) (UE4 + 0xA772850);
-		blGNames = true;
-       }
 	return true;
 }
 
+void ObjectsStore::GetMemoryRanges(std::vector<std::pair<const void*, size_t>>& ranges)
+{
+	ranges.emplace_back(GUObjectArray, sizeof(FUObjectArray));
+	ranges.emplace_back(GUObjectArray->ObjObjects.Objects, GUObjectArray->ObjObjects.NumElements * sizeof(FUObjectItem));
+}
 
 void* ObjectsStore::GetAddress()
 {
@@ -176,7 +292,140 @@ size_t ObjectsStore::GetObjectsNum() const
 
 UEObject ObjectsStore::GetById(size_t id) const
 {
-	return GUObjectArray->ObjObjects.Objects[id].Object;
+	const auto object = GUObjectArray->ObjObjects.Objects[id].Object;
+	if (!ReflectionSnapshot::IsInitialized())
+	{
+		return object;
+	}
+
+	//the slot tells the row, the object itself is not read
+	return UEObject(object, ReflectionSnapshot().GetRow(id, object));
+}
+
+int32_t ObjectsStore::GetSerialNumber(size_t id) const
+{
+	return GUObjectArray->ObjObjects.Objects[id].SerialNumber;
 }
 
+bool ObjectsStore::InitializeIndex()
+{
+	if (objectIndex.Initialized)
+	{
+		return true;
+	}
+
+	const ObjectsStore store;
+	const auto count = store.GetObjectsNum();
+
+	objectIndex.Slots.assign(count, nullptr);
+	objectIndex.Objects.reserve(count);
+
+	const auto snapshotAvailable = ReflectionSnapshot::IsInitialized();
+	if (!snapshotAvailable)
+	{
+		//reserved up front, the index keeps views into the strings
+		objectIndex.FullNames.reserve(count);
+	}
+
+	//the classes are not indexed yet, so the collision kinds of every class are resolved by name once
+	std::unordered_map<void*, uint8_t> classKinds;
 
+	const ReflectionSnapshot snapshot;
+	for (auto i = 0u; i < count; ++i)
+	{
+		const auto obj = store.GetById(i);
+		if (!obj.IsValid())
+		{
+			continue;
+		}
+
+		//count the constants, enums and structs per name
+		const auto cls = obj.GetClass();
+		auto it = classKinds.find(cls.GetAddress());
+		if (it == std::end(classKinds))
+		{
+			it = classKinds.emplace(cls.GetAddress(), GetCollisionKinds(cls)).first;
+		}
+		if (it->second != 0)
+		{
+			const auto key = MakeNameKey(obj);
+			for (auto kind = 0u; kind < CollisionKindNames.size(); ++kind)
+			{
+				if (it->second & (1 << kind))
+				{
+					++objectIndex.Collisions[kind][key];
+				}
+			}
+		}
+
+		std::string_view fullName;
+		if (snapshotAvailable)
+		{
+			const auto row = obj.GetRow();
+			if (row != ReflectionSnapshot::NullRow && snapshot.GetClass(row) != ReflectionSnapshot::NullRow)
+			{
+				fullName = snapshot.GetFullName(row);
+			}
+			if (fullName.data() == nullptr)
+			{
+				//not captured, FindObject scans these objects
+				continue;
+			}
+		}
+		else
+		{
+			objectIndex.FullNames.emplace_back(obj.GetFullName());
+			fullName = objectIndex.FullNames.back();
+		}
+
+		objectIndex.Slots[i] = obj.GetAddress();
+		objectIndex.Objects.emplace(fullName, obj);
+	}
+
+	objectIndex.Initialized = true;
+
+	//the classes the collisions got counted for, resolved through the index
+	objectIndex.CollisionKinds = { UEConst::StaticClass(), UEEnum::StaticClass(), UEStruct::StaticClass() };
+
+	//the first call of every StaticClass() caches the class
+	UEObject::StaticClass();
+	UEField::StaticClass();
+	UEEnum::StaticClass();
+	UEConst::StaticClass();
+	UEStruct::StaticClass();
+	UEScriptStruct::StaticClass();
+	UEFunction::StaticClass();
+	UEClass::StaticClass();
+	UEProperty::StaticClass();
+	UENumericProperty::StaticClass();
+	UEByteProperty::StaticClass();
+	UEUInt16Property::StaticClass();
+	UEUInt32Property::StaticClass();
+	UEUInt64Property::StaticClass();
+	UEInt8Property::StaticClass();
+	UEInt16Property::StaticClass();
+	UEIntProperty::StaticClass();
+	UEInt64Property::StaticClass();
+	UEFloatProperty::StaticClass();
+	UEDoubleProperty::StaticClass();
+	UEBoolProperty::StaticClass();
+	UEObjectPropertyBase::StaticClass();
+	UEObjectProperty::StaticClass();
+	UEClassProperty::StaticClass();
+	UEInterfaceProperty::StaticClass();
+	UEWeakObjectProperty::StaticClass();
+	UELazyObjectProperty::StaticClass();
+	UEAssetObjectProperty::StaticClass();
+	UEAssetClassProperty::StaticClass();
+	UENameProperty::StaticClass();
+	UEStructProperty::StaticClass();
+	UEStrProperty::StaticClass();
+	UETextProperty::StaticClass();
+	UEArrayProperty::StaticClass();
+	UEMapProperty::StaticClass();
+	UEDelegateProperty::StaticClass();
+	UEMulticastDelegateProperty::StaticClass();
+	UEEnumProperty::StaticClass();
+
+	return true;
+}
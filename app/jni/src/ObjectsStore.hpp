@@ -1,6 +1,8 @@
 #pragma once
 
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "UE4/GenericTypes.hpp"
 
@@ -11,13 +13,36 @@ class ObjectsStore
 public:
 
 	/// <summary>
-	/// Initializes this object.
+	/// Initializes this object with the "GUObjectArray" signatures of the generator (<see cref="IGenerator::GetSignatures" />).
+	/// Does not wait, it can be called again until libUE4.so is loaded.
 	/// </summary>
 	/// <returns>
-	/// true if it succeeds, false if it fails.
+	/// true if it succeeds, false if libUE4.so is not loaded yet or no signature resolves.
 	/// </returns>
 	static bool Initialize();
 
+	/// <summary>
+	/// Initializes this object with a known address of the global objects store,
+	/// e.g. the one recorded in a snapshot file (<see cref="SnapshotFile" />).
+	/// </summary>
+	/// <param name="address">The address of the global objects store.</param>
+	/// <returns>true if it succeeds, false if it fails.</returns>
+	static bool Initialize(void* address);
+
+	/// <summary>
+	/// Builds the full name index used by <see cref="FindObject" /> and <see cref="FindClass" />
+	/// and resolves the classes of all wrapper types in the same go.
+	/// Uses the reflection snapshot if it got built.
+	/// </summary>
+	/// <returns>true if it succeeds, false if it fails.</returns>
+	static bool InitializeIndex();
+
+	/// <summary>
+	/// Adds the memory the global objects store consists of (the store and its items, not the objects) to the ranges.
+	/// </summary>
+	/// <param name="ranges">[in,out] The address and size of every memory range.</param>
+	static void GetMemoryRanges(std::vector<std::pair<const void*, size_t>>& ranges);
+
 	/// <summary>Gets the address of the global objects store.</summary>
 	/// <returns>The address of the global objects store.</returns>
 	static void* GetAddress();
@@ -43,6 +68,21 @@ public:
 	/// <returns>The object.</returns>
 	UEObject GetById(size_t id) const;
 
+	/// <summary>
+	/// Gets the serial number of the object slot. The engine assigns it on demand (0 if none got assigned yet)
+	/// and changes it when the slot gets reused by another object.
+	/// </summary>
+	/// <param name="id">The identifier.</param>
+	/// <returns>The serial number.</returns>
+	int32_t GetSerialNumber(size_t id) const;
+
+	/// <summary>
+	/// Searches for the first object with the given full name ("Class CoreUObject.Object").
+	/// </summary>
+	/// <param name="name">The full name of the object.</param>
+	/// <returns>The found object which is not valid if no object could be found.</returns>
+	UEObject FindObject(const std::string& name) const;
+
 	/// <summary>
 	/// Searches for the first class with the given name.
 	/// </summary>
@@ -52,33 +92,22 @@ public:
 
 	/// <summary>Count objects which have the same name and type.</summary>
 	/// <typeparam name="T">Type of the object.</typeparam>
-	/// <param name="name">The name to search for.</param>
+	/// <param name="obj">The object whose name to search for.</param>
 	/// <returns>The number of objects which share a name.</returns>
 	template<class T>
-	size_t CountObjects(const std::string& name) const
+	size_t CountObjects(const T& obj) const
 	{
-		static std::unordered_map<std::string, size_t> cache;
-
-		auto it = cache.find(name);
-		if (it != std::end(cache))
-		{
-			return it->second;
-		}
-
-		size_t count = 0;
-	/*	for (auto obj : *this)
-		{
-			if (obj.IsA<T>() && obj.GetName() == name)
-			{
-				++count;
-			}
-		}
-        */
-
-		cache[name] = count;
-
-		return count;
+		return CountObjects(T::StaticClass(), obj);
 	}
+
+	/// <summary>
+	/// Count objects which have the same name as the object and are instances of the class.
+	/// Constants, enums and structs are answered from the collision index built by <see cref="InitializeIndex()" />.
+	/// </summary>
+	/// <param name="cls">The class of the objects to count.</param>
+	/// <param name="obj">The object whose name to search for.</param>
+	/// <returns>The number of objects which share a name.</returns>
+	size_t CountObjects(const UEClass& cls, const UEObject& obj) const;
 };
 
 /// <summary>Holds information about an object.</summary>
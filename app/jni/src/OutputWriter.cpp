@@ -0,0 +1,469 @@
+#include "OutputWriter.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>) && defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#include <linux/io_uring.h>
+#define OUTPUT_WRITER_IO_URING 1
+#endif
+#endif
+
+#include "Logger.hpp"
+
+namespace
+{
+	struct OutputFile
+	{
+		std::string Path;
+		std::string Content;
+	};
+
+	int OpenFile(const OutputFile& file)
+	{
+		const auto fd = open(file.Path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+		if (fd < 0)
+		{
+			Logger::Log("Could not open %s: %s", file.Path, strerror(errno));
+		}
+		return fd;
+	}
+
+	/// <summary>Writes the remaining content of the file starting at the offset.</summary>
+	void WriteRemaining(int fd, const OutputFile& file, size_t offset)
+	{
+		while (offset < file.Content.size())
+		{
+			const auto written = pwrite(fd, file.Content.data() + offset, file.Content.size() - offset, offset);
+			if (written < 0)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+
+				Logger::Log("Could not write %s: %s", file.Path, strerror(errno));
+				return;
+			}
+			offset += written;
+		}
+	}
+
+	void WriteFile(const OutputFile& file)
+	{
+		const auto fd = OpenFile(file);
+		if (fd < 0)
+		{
+			return;
+		}
+
+		WriteRemaining(fd, file, 0);
+
+		close(fd);
+	}
+
+#ifdef OUTPUT_WRITER_IO_URING
+	/// <summary>A minimal io_uring instance used through the raw system calls.</summary>
+	class IoUring
+	{
+	public:
+		~IoUring()
+		{
+			Close();
+		}
+
+		bool Setup(unsigned requestedEntries)
+		{
+			io_uring_params params;
+			memset(&params, 0, sizeof(params));
+
+			fd = static_cast<int>(syscall(__NR_io_uring_setup, requestedEntries, &params));
+			if (fd < 0)
+			{
+				return false;
+			}
+
+			sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+			cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+			sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+
+			sqRing = Map(sqRingSize, IORING_OFF_SQ_RING);
+			cqRing = Map(cqRingSize, IORING_OFF_CQ_RING);
+			sqes = static_cast<io_uring_sqe*>(Map(sqesSize, IORING_OFF_SQES));
+			if (sqRing == nullptr || cqRing == nullptr || sqes == nullptr)
+			{
+				return false;
+			}
+
+			const auto sq = static_cast<uint8_t*>(sqRing);
+			sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+			sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+			sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+			const auto cq = static_cast<uint8_t*>(cqRing);
+			cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+			cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+			cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+			cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+			entries = params.sq_entries;
+
+			return true;
+		}
+
+		unsigned GetEntries() const { return entries; }
+
+		/// <summary>
+		/// Writes the files (at most <see cref="GetEntries()" />) with one submission.
+		/// All files are written when it returns, the files io_uring did not finish are written with write().
+		/// </summary>
+		/// <returns>false if the ring failed and got closed, it must not be used again.</returns>
+		bool WriteFiles(const OutputFile* files, size_t count)
+		{
+			std::vector<int> fds(count);
+			std::vector<iovec> iovecs(count);
+
+			auto tail = __atomic_load_n(sqTail, __ATOMIC_ACQUIRE);
+			unsigned submitted = 0;
+			for (auto i = 0u; i < count; ++i)
+			{
+				fds[i] = OpenFile(files[i]);
+				if (fds[i] < 0 || files[i].Content.empty())
+				{
+					continue;
+				}
+
+				iovecs[i].iov_base = const_cast<char*>(files[i].Content.data());
+				iovecs[i].iov_len = files[i].Content.size();
+
+				const auto index = tail & sqMask;
+				auto& sqe = sqes[index];
+				memset(&sqe, 0, sizeof(sqe));
+				sqe.opcode = IORING_OP_WRITEV;
+				sqe.fd = fds[i];
+				sqe.addr = reinterpret_cast<uint64_t>(&iovecs[i]);
+				sqe.len = 1;
+				sqe.off = 0;
+				sqe.user_data = i;
+				sqArray[index] = index;
+
+				++tail;
+				++submitted;
+			}
+			__atomic_store_n(sqTail, tail, __ATOMIC_RELEASE);
+
+			std::vector<int> results(count, 0);
+			std::vector<bool> completed(count);
+			auto pending = submitted;
+			auto toSubmit = submitted;
+
+			const auto reap = [&]()
+			{
+				unsigned reaped = 0;
+				auto head = __atomic_load_n(cqHead, __ATOMIC_RELAXED);
+				while (head != __atomic_load_n(cqTail, __ATOMIC_ACQUIRE))
+				{
+					const auto& cqe = cqes[head & cqMask];
+					results[cqe.user_data] = cqe.res;
+					completed[cqe.user_data] = true;
+					++head;
+					++reaped;
+				}
+				__atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+				pending -= reaped;
+				return reaped;
+			};
+
+			auto healthy = true;
+			auto stalls = 0u;
+			while (pending > 0)
+			{
+				const auto ret = syscall(__NR_io_uring_enter, fd, toSubmit, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+				if (ret < 0)
+				{
+					const auto error = errno;
+					if (error == EINTR)
+					{
+						continue;
+					}
+
+					//out of resources or a full completion queue, the completions make room for the submission
+					if ((error == EAGAIN || error == EBUSY) && stalls < MaxStalls)
+					{
+						if (reap() == 0)
+						{
+							++stalls;
+							std::this_thread::yield();
+						}
+						else
+						{
+							stalls = 0;
+						}
+						continue;
+					}
+
+					//the submitted writes still read the buffers of this batch and write into its fds, they must complete
+					//before the files are finished with write(); the queued entries would be submitted later with them,
+					//so the ring is closed once it is idle
+					Logger::Log("io_uring_enter failed: %s, writing the files with write()", strerror(error));
+					Drain(pending - toSubmit, reap);
+					Close();
+					healthy = false;
+					break;
+				}
+				toSubmit -= std::min<unsigned>(toSubmit, static_cast<unsigned>(ret));
+				stalls = 0;
+
+				reap();
+			}
+
+			for (auto i = 0u; i < count; ++i)
+			{
+				if (fds[i] < 0)
+				{
+					continue;
+				}
+
+				//short or failed writes are finished with write()
+				WriteRemaining(fds[i], files[i], completed[i] && results[i] > 0 ? results[i] : 0);
+
+				close(fds[i]);
+			}
+
+			return healthy;
+		}
+
+	private:
+		/// <summary>The number of retries of a busy ring without any completion before it is given up.</summary>
+		static constexpr unsigned MaxStalls = 1000;
+
+		/// <summary>Waits until the submitted requests completed, without submitting the queued ones.</summary>
+		/// <param name="inFlight">The number of requests the kernel consumed and did not complete yet.</param>
+		/// <param name="reap">Reaps the completion queue and returns the number of completions.</param>
+		template<typename Fn>
+		void Drain(unsigned inFlight, Fn&& reap)
+		{
+			while (true)
+			{
+				inFlight -= std::min(inFlight, reap());
+				if (inFlight == 0)
+				{
+					return;
+				}
+
+				const auto ret = syscall(__NR_io_uring_enter, fd, 0, inFlight, IORING_ENTER_GETEVENTS, nullptr, 0);
+				if (ret < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+				{
+					//the kernel completes the requests without waiting as well, the completion queue is polled then
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				}
+			}
+		}
+
+		/// <summary>Unmaps and closes the ring, no request may be in flight.</summary>
+		void Close()
+		{
+			if (sqes != nullptr) munmap(sqes, sqesSize);
+			if (cqRing != nullptr) munmap(cqRing, cqRingSize);
+			if (sqRing != nullptr) munmap(sqRing, sqRingSize);
+			if (fd >= 0) close(fd);
+
+			sqes = nullptr;
+			cqRing = nullptr;
+			sqRing = nullptr;
+			fd = -1;
+		}
+
+		void* Map(size_t size, off_t offset) const
+		{
+			const auto address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+			return address == MAP_FAILED ? nullptr : address;
+		}
+
+		int fd = -1;
+		unsigned entries = 0;
+
+		void* sqRing = nullptr;
+		size_t sqRingSize = 0;
+		unsigned* sqTail = nullptr;
+		unsigned sqMask = 0;
+		unsigned* sqArray = nullptr;
+
+		void* cqRing = nullptr;
+		size_t cqRingSize = 0;
+		unsigned* cqHead = nullptr;
+		unsigned* cqTail = nullptr;
+		unsigned cqMask = 0;
+		io_uring_cqe* cqes = nullptr;
+
+		io_uring_sqe* sqes = nullptr;
+		size_t sqesSize = 0;
+	};
+#endif
+
+	struct WriterState
+	{
+		std::mutex Mutex;
+		std::condition_variable Condition;
+		/// <summary>Signaled when written files released their buffers.</summary>
+		std::condition_variable Drained;
+		std::deque<OutputFile> Pending;
+		/// <summary>The size of the pending files and of the batch being written.</summary>
+		size_t QueuedBytes = 0;
+		bool Running = false;
+		bool Stopping = false;
+		std::thread Thread;
+	};
+
+	WriterState state;
+
+	/// <summary>The number of files written with one submission.</summary>
+	constexpr size_t BatchSize = 64;
+
+	/// <summary>
+	/// The size of the files which may wait for the writer. Rendering blocks above it, so a slow disk bounds the memory
+	/// instead of letting the rendered packages pile up.
+	/// </summary>
+	constexpr size_t MaxQueuedBytes = 32 * 1024 * 1024;
+
+	void Run(bool useIoUring)
+	{
+#ifdef OUTPUT_WRITER_IO_URING
+		std::unique_ptr<IoUring> ring;
+		if (useIoUring)
+		{
+			ring = std::make_unique<IoUring>();
+			if (!ring->Setup(BatchSize))
+			{
+				Logger::Log("io_uring is not available, writing the files with write()");
+				ring.reset();
+			}
+		}
+#endif
+
+		std::vector<OutputFile> batch;
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(state.Mutex);
+				state.Condition.wait(lock, [] { return !state.Pending.empty() || state.Stopping; });
+				if (state.Pending.empty())
+				{
+					return;
+				}
+
+				batch.clear();
+				while (!state.Pending.empty() && batch.size() < BatchSize)
+				{
+					batch.emplace_back(std::move(state.Pending.front()));
+					state.Pending.pop_front();
+				}
+			}
+
+#ifdef OUTPUT_WRITER_IO_URING
+			size_t ringWritten = 0;
+			while (ring != nullptr && ringWritten < batch.size())
+			{
+				const auto count = std::min<size_t>(ring->GetEntries(), batch.size() - ringWritten);
+				if (!ring->WriteFiles(batch.data() + ringWritten, count))
+				{
+					//the failed ring is gone for good, the rest of the run uses write()
+					ring.reset();
+				}
+				ringWritten += count;
+			}
+			for (auto i = ringWritten; i < batch.size(); ++i)
+			{
+				WriteFile(batch[i]);
+			}
+#else
+			for (auto&& file : batch)
+			{
+				WriteFile(file);
+			}
+#endif
+
+			size_t written = 0;
+			for (auto&& file : batch)
+			{
+				written += file.Content.size();
+			}
+			batch.clear();
+
+			{
+				std::lock_guard<std::mutex> lock(state.Mutex);
+				state.QueuedBytes -= written;
+			}
+			state.Drained.notify_all();
+		}
+	}
+}
+
+void OutputWriter::Start(bool useIoUring)
+{
+	std::lock_guard<std::mutex> lock(state.Mutex);
+
+	if (state.Running)
+	{
+		return;
+	}
+
+	state.Running = true;
+	state.Stopping = false;
+	state.Thread = std::thread(Run, useIoUring);
+}
+
+void OutputWriter::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(state.Mutex);
+
+		if (!state.Running)
+		{
+			return;
+		}
+
+		state.Stopping = true;
+	}
+	state.Condition.notify_one();
+
+	state.Thread.join();
+
+	std::lock_guard<std::mutex> lock(state.Mutex);
+	state.Running = false;
+}
+
+void OutputWriter::Write(std::string path, std::string&& content)
+{
+	{
+		std::unique_lock<std::mutex> lock(state.Mutex);
+
+		if (state.Running)
+		{
+			//a file larger than the limit is still accepted when nothing else waits
+			state.Drained.wait(lock, [&] { return state.QueuedBytes == 0 || state.QueuedBytes + content.size() <= MaxQueuedBytes; });
+
+			state.QueuedBytes += content.size();
+			state.Pending.push_back({ std::move(path), std::move(content) });
+			state.Condition.notify_one();
+			return;
+		}
+	}
+
+	WriteFile({ std::move(path), std::move(content) });
+}
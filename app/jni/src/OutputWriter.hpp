@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+
+/// <summary>
+/// Writes the generated files on a dedicated thread.
+/// The generators render every file into an owned buffer and hand it over, so rendering the next
+/// file overlaps with writing the previous ones. Pending files are written in batches, through
+/// io_uring if it is enabled and supported by the kernel and through plain write() otherwise.
+/// </summary>
+class OutputWriter
+{
+public:
+	/// <summary>
+	/// Starts the writer thread.
+	/// Files which are handed over while the writer is not running are written immediately.
+	/// </summary>
+	/// <param name="useIoUring">true to submit the writes through io_uring if the kernel supports it.</param>
+	static void Start(bool useIoUring);
+
+	/// <summary>Writes all pending files and stops the writer thread.</summary>
+	static void Stop();
+
+	/// <summary>
+	/// Queues the file for writing. An existing file gets replaced.
+	/// Blocks while the queued files exceed a size limit until the writer caught up.
+	/// </summary>
+	/// <param name="path">The path of the file.</param>
+	/// <param name="content">The content of the file.</param>
+	static void Write(std::string path, std::string&& content);
+};
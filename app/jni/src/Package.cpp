@@ -1,13 +1,24 @@
 #include "Package.hpp"
 
-#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <queue>
+#include <tuple>
 #include <unordered_set>
+
+#include <sys/mman.h>
+
 #include "tinyformat.h"
 #include "cpplinq.hpp"
 #include "Logger.hpp"
+#include "OutputWriter.hpp"
+#include "Hash.hpp"
 #include "IGenerator.hpp"
+#include "ModuleMap.hpp"
 #include "NameValidator.hpp"
 #include "ObjectsStore.hpp"
+#include "PatternScanner.hpp"
 #include "PropertyFlags.hpp"
 #include "FunctionFlags.hpp"
 #include "PrintHelper.hpp"
@@ -16,8 +27,6 @@
 uintptr_t libBaseAddr = 0;
 uintptr_t libEndAddr = 0;
 
-std::unordered_map<UEObject, const Package*> Package::PackageMap;
-
 /// <summary>
 /// Compare two properties.
 /// </summary>
@@ -41,34 +50,60 @@ Package::Package(const UEObject& _packageObj)
 {
 }
 
-void Package::Process(std::unordered_map<UEObject, bool>& processedObjects)
+PackageIndex::PackageIndex()
 {
+	std::unordered_map<UEObject, size_t> packageIndices;
+
 	for (auto obj : ObjectsStore())
 	{
+		//the package of every captured object is precomputed by the reflection snapshot
 		const auto package = obj.GetPackageObject();
-		if (packageObj == package)
+		if (!package.IsValid())
 		{
-			if (obj.IsA<UEEnum>())
-			{
-				GenerateEnum(obj.Cast<UEEnum>());
-			}
-			else if (obj.IsA<UEConst>())
-			{
-				GenerateConst(obj.Cast<UEConst>());
-			}
-			else if (obj.IsA<UEClass>())
-			{
-				GeneratePrerequisites(obj, processedObjects);
-			}
-			else if (obj.IsA<UEScriptStruct>())
-			{
-				GeneratePrerequisites(obj, processedObjects);
-			}
+			continue;
+		}
+
+		auto it = packageIndices.find(package);
+		if (it == std::end(packageIndices))
+		{
+			it = packageIndices.emplace(package, packages.size()).first;
+			packages.push_back(package);
+			typeObjects.emplace_back();
+		}
+
+		if (obj.IsA<UEEnum>() || obj.IsA<UEConst>() || obj.IsA<UEClass>() || obj.IsA<UEScriptStruct>())
+		{
+			typeObjects[it->second].push_back(obj);
 		}
 	}
 }
 
-bool Package::Save(std::string path) const
+void Package::Process(const std::vector<UEObject>& typeObjects, std::unordered_map<UEObject, bool>& processedObjects)
+{
+	for (auto obj : typeObjects)
+	{
+		if (obj.IsA<UEEnum>())
+		{
+			GenerateEnum(obj.Cast<UEEnum>());
+		}
+		else if (obj.IsA<UEConst>())
+		{
+			GenerateConst(obj.Cast<UEConst>());
+		}
+		else if (obj.IsA<UEClass>())
+		{
+			GeneratePrerequisites(obj, processedObjects);
+		}
+		else if (obj.IsA<UEScriptStruct>())
+		{
+			GeneratePrerequisites(obj, processedObjects);
+		}
+	}
+
+	hash = ComputeHash();
+}
+
+bool Package::Save(std::string path, const Manifest& previous) const
 {
 	extern IGenerator* generator;
 
@@ -82,6 +117,11 @@ bool Package::Save(std::string path) const
 		)
 	)
 	{
+		if (previous.HasPackage(GetName(), hash) && FilesExist(path))
+		{
+			return true;
+		}
+
 		SaveStructs(path);
 		SaveClasses(path);
 		SaveFunctions(path);
@@ -94,6 +134,246 @@ bool Package::Save(std::string path) const
 	return false;
 }
 
+void Package::SortByDependencies(std::vector<PackageRecord>& packages)
+{
+	const auto count = packages.size();
+
+	std::unordered_map<UEObject, size_t> indices;
+	for (auto i = 0u; i < count; ++i)
+	{
+		indices.emplace(packages[i].PackageObj, i);
+	}
+
+	//the edges point from a package to the packages it depends on and back
+	std::vector<std::vector<size_t>> dependencies(count);
+	std::vector<std::vector<size_t>> dependents(count);
+	std::vector<size_t> pending(count);
+	for (auto i = 0u; i < count; ++i)
+	{
+		for (auto&& dep : packages[i].Dependencies)
+		{
+			const auto it = indices.find(dep);
+			if (it == std::end(indices) || it->second == i)
+			{
+				//missing package (without generated code)
+				continue;
+			}
+
+			dependencies[i].push_back(it->second);
+			dependents[it->second].push_back(i);
+		}
+		std::sort(std::begin(dependencies[i]), std::end(dependencies[i]));
+
+		pending[i] = dependencies[i].size();
+	}
+
+	std::priority_queue<size_t, std::vector<size_t>, std::greater<size_t>> ready;
+	for (auto i = 0u; i < count; ++i)
+	{
+		if (pending[i] == 0)
+		{
+			ready.push(i);
+		}
+	}
+
+	std::vector<bool> emitted(count);
+	std::vector<size_t> order;
+	order.reserve(count);
+
+	while (order.size() < count)
+	{
+		if (ready.empty())
+		{
+			//every remaining package waits for another one, follow the first open dependency until a package repeats
+			auto start = 0u;
+			while (emitted[start])
+			{
+				++start;
+			}
+
+			std::vector<size_t> path;
+			std::vector<size_t> position(count, count);
+			auto current = start;
+			while (position[current] == count)
+			{
+				position[current] = path.size();
+				path.push_back(current);
+				current = *std::find_if(std::begin(dependencies[current]), std::end(dependencies[current]), [&](size_t dep) { return !emitted[dep]; });
+			}
+
+			const auto cycleBegin = std::begin(path) + position[current];
+			const auto first = *std::min_element(cycleBegin, std::end(path));
+
+			std::string cycle;
+			for (auto it = cycleBegin; it != std::end(path); ++it)
+			{
+				cycle += packages[*it].Name + " -> ";
+			}
+			cycle += packages[current].Name;
+
+			Logger::Log("Dependency cycle between packages: %s (emitting %s first)", cycle, packages[first].Name);
+
+			ready.push(first);
+		}
+
+		const auto i = ready.top();
+		ready.pop();
+		if (emitted[i])
+		{
+			continue;
+		}
+
+		emitted[i] = true;
+		order.push_back(i);
+
+		for (auto dependent : dependents[i])
+		{
+			if (--pending[dependent] == 0 && !emitted[dependent])
+			{
+				ready.push(dependent);
+			}
+		}
+	}
+
+	std::vector<PackageRecord> sorted;
+	sorted.reserve(count);
+	for (auto i : order)
+	{
+		sorted.emplace_back(std::move(packages[i]));
+	}
+	packages = std::move(sorted);
+}
+
+bool Package::FilesExist(const std::string& path) const
+{
+	extern IGenerator* generator;
+
+	const auto exists = [&](FileContentType type)
+	{
+		return access((path + "/" + GenerateFileName(type, *this)).c_str(), F_OK) == 0;
+	};
+
+	return exists(FileContentType::Structs)
+		&& exists(FileContentType::Classes)
+		&& exists(FileContentType::Functions)
+		&& (!generator->ShouldGenerateFunctionParametersFile() || exists(FileContentType::FunctionParameters));
+}
+
+uint64_t Package::ComputeHash() const
+{
+	extern IGenerator* generator;
+
+	Fnv1a hasher;
+	hasher.Add(GetName());
+
+	//only what gets printed is hashed (the flags of padding members are not initialized)
+	//the constants are printed in the order of the map, so their hashes are combined independent of the order
+	uint64_t constantsHash = 0;
+	for (auto&& c : constants)
+	{
+		constantsHash += Fnv1a().Add(c.first).Add(c.second).Get();
+	}
+	hasher.Add(constantsHash);
+
+	hasher.Add(enums.size());
+	for (auto&& e : enums)
+	{
+		hasher.Add(e.Name).Add(e.FullName).Add(e.Values.size());
+		for (auto&& value : e.Values)
+		{
+			hasher.Add(value);
+		}
+	}
+
+	const auto addStruct = [&](const ScriptStruct& ss)
+	{
+		hasher.Add(ss.Name).Add(ss.FullName).Add(ss.NameCpp).Add(ss.NameCppFull).Add(ss.Size).Add(ss.InheritedSize);
+
+		hasher.Add(ss.Members.size());
+		for (auto&& m : ss.Members)
+		{
+			hasher.Add(m.Name).Add(m.Type).Add(m.Offset).Add(m.Size).Add(m.FlagsString).Add(m.Comment);
+		}
+
+		hasher.Add(ss.PredefinedMethods.size());
+		for (auto&& m : ss.PredefinedMethods)
+		{
+			hasher.Add(m.Signature).Add(m.Body).Add(m.MethodType);
+		}
+	};
+
+	hasher.Add(scriptStructs.size());
+	for (auto&& ss : scriptStructs)
+	{
+		addStruct(ss);
+	}
+
+	hasher.Add(classes.size());
+	for (auto&& c : classes)
+	{
+		addStruct(c);
+
+		hasher.Add(c.VirtualFunctions.size());
+		for (auto&& f : c.VirtualFunctions)
+		{
+			hasher.Add(f);
+		}
+
+		hasher.Add(c.Methods.size());
+		for (auto&& m : c.Methods)
+		{
+			//the position in GUObjectArray changes with every patch, only the index mode renders it
+			if (!generator->ShouldUseStrings())
+			{
+				hasher.Add(m.Index);
+			}
+			hasher.Add(m.Slot).Add(m.Name).Add(m.FullName).Add(m.FlagsString).Add(m.IsNative).Add(m.IsStatic);
+
+			hasher.Add(m.Parameters.size());
+			for (auto&& p : m.Parameters)
+			{
+				hasher.Add(p.ParamType).Add(p.PassByReference).Add(p.CppType).Add(p.Name).Add(p.FlagsString);
+			}
+		}
+	}
+
+	hasher.Add(objectSlots.size());
+	for (auto&& slot : objectSlots)
+	{
+		hasher.Add(slot.FullName);
+		if (!generator->ShouldUseStrings())
+		{
+			hasher.Add(slot.Index).Add(slot.SerialNumber);
+		}
+	}
+
+	return hasher.Get();
+}
+
+std::string Package::GetObjectSlotsPrefix() const
+{
+	return GetObjectSlotsPrefix(GetName());
+}
+
+std::string Package::GetObjectSlotsPrefix(std::string name)
+{
+	return MakeValidName(std::move(name));
+}
+
+PackageRecord Package::GetRecord() const
+{
+	return { packageObj, GetName(), hash, objectSlots.size(), std::vector<UEObject>(std::begin(dependencies), std::end(dependencies)) };
+}
+
+size_t Package::AddObjectSlot(const UEObject& obj, std::string_view fullName)
+{
+	const ObjectsStore store;
+
+	objectSlots.push_back({ fullName, obj.GetIndex(), store.GetSerialNumber(obj.GetIndex()) });
+
+	return objectSlots.size() - 1;
+}
+
 bool Package::AddDependency(const UEObject& package) const
 {
 	if (package != packageObj)
@@ -119,10 +399,11 @@ void Package::GeneratePrerequisites(const UEObject& obj, std::unordered_map<UEOb
 		return;
 	}
 
-	const auto name = obj.GetName();
-	if (name.find("Default__") != std::string::npos
-		|| name.find("<uninitialized>") != std::string::npos
-		|| name.find("PLACEHOLDER-CLASS") != std::string::npos)
+	std::string buffer;
+	const auto name = obj.GetNameView(buffer);
+	if (name.find("Default__") != std::string_view::npos
+		|| name.find("<uninitialized>") != std::string_view::npos
+		|| name.find("PLACEHOLDER-CLASS") != std::string_view::npos)
 	{
 		return;
 	}
@@ -233,23 +514,25 @@ void Package::GenerateScriptStruct(const UEScriptStruct& scriptStructObj)
 {
 	extern IGenerator* generator;
 
+	std::string buffer;
 	ScriptStruct ss;
-	ss.Name = scriptStructObj.GetName();
-	ss.FullName = scriptStructObj.GetFullName();
+	ss.Name = arena.Store(scriptStructObj.GetNameView(buffer));
+	const auto fullName = scriptStructObj.GetFullName();
+	ss.FullName = arena.Store(fullName);
 
 	//Logger::Log("ScriptStruct: %-100s - instance: 0x%P", ss.Name, scriptStructObj.GetAddress());
 
-	ss.NameCpp = MakeValidName(scriptStructObj.GetNameCPP());
-	ss.NameCppFull = "struct ";
+	ss.NameCpp = arena.Store(MakeValidName(scriptStructObj.GetNameCPP()));
+	std::string nameCppFull = "struct ";
 
 	//some classes need special alignment
-	const auto alignment = generator->GetClassAlignas(ss.FullName);
+	const auto alignment = generator->GetClassAlignas(fullName);
 	if (alignment != 0)
 	{
-		ss.NameCppFull += tfm::format("alignas(%d) ", alignment);
+		nameCppFull += tfm::format("alignas(%d) ", alignment);
 	}
 
-	ss.NameCppFull += MakeUniqueCppName(scriptStructObj);
+	nameCppFull += MakeUniqueCppName(scriptStructObj);
 
 	ss.Size = scriptStructObj.GetPropertySize();
 	ss.InheritedSize = 0;
@@ -261,9 +544,11 @@ void Package::GenerateScriptStruct(const UEScriptStruct& scriptStructObj)
 	{
 		ss.InheritedSize = offset = super.GetPropertySize();
 
-		ss.NameCppFull += " : public " + MakeUniqueCppName(super.Cast<UEScriptStruct>());
+		nameCppFull += " : public " + MakeUniqueCppName(super.Cast<UEScriptStruct>());
 	}
 
+	ss.NameCppFull = arena.Store(nameCppFull);
+
 	std::vector<UEProperty> properties;
 	for (auto prop = scriptStructObj.GetChildren().Cast<UEProperty>(); prop.IsValid(); prop = prop.GetNext().Cast<UEProperty>())
 	{
@@ -281,25 +566,27 @@ void Package::GenerateScriptStruct(const UEScriptStruct& scriptStructObj)
 
 	GenerateMembers(scriptStructObj, offset, properties, ss.Members);
 
-	generator->GetPredefinedClassMethods(scriptStructObj.GetFullName(), ss.PredefinedMethods);
+	AddPredefinedMethods(fullName, ss.PredefinedMethods);
 
 	scriptStructs.emplace_back(std::move(ss));
 }
 
 void Package::GenerateEnum(const UEEnum& enumObj)
 {
-	Enum e;
-	e.Name = MakeUniqueCppName(enumObj);
+	const auto name = MakeUniqueCppName(enumObj);
 
-	if (e.Name.find("Default__") != std::string::npos
-		|| e.Name.find("PLACEHOLDER-CLASS") != std::string::npos)
+	if (name.find("Default__") != std::string::npos
+		|| name.find("PLACEHOLDER-CLASS") != std::string::npos)
 	{
 		return;
 	}
 
-	e.FullName = enumObj.GetFullName();
+	Enum e;
+	e.Name = arena.Store(name);
+	std::string buffer;
+	e.FullName = arena.Store(enumObj.GetFullNameView(buffer));
 
-	std::unordered_map<std::string, int> conflicts;
+	std::unordered_map<std::string_view, int> conflicts;
 	for (auto&& s : enumObj.GetNames())
 	{
 		const auto clean = MakeValidName(std::move(s));
@@ -307,13 +594,14 @@ void Package::GenerateEnum(const UEEnum& enumObj)
 		const auto it = conflicts.find(clean);
 		if (it == std::end(conflicts))
 		{
-			e.Values.push_back(clean);
-			conflicts[clean] = 1;
+			const auto value = arena.Store(clean);
+			e.Values.push_back(value);
+			conflicts[value] = 1;
 		}
 		else
 		{
-			e.Values.push_back(clean + tfm::format("%02d", it->second));
-			conflicts[clean]++;
+			e.Values.push_back(arena.Format("%s%02d", clean.c_str(), it->second));
+			it->second++;
 		}
 	}
 
@@ -334,18 +622,121 @@ void Package::GenerateConst(const UEConst& constObj)
 	constants[name] = constObj.GetValue();
 }
 
+namespace
+{
+	/// <summary>
+	/// The virtual functions found by the patterns of <see cref="IGenerator::GetVirtualFunctionPatterns" />.
+	/// The classes share their vtables, so every vtable is measured once and scanned once per pattern in a run.
+	/// The classes get generated on the worker threads, the cache is locked.
+	/// </summary>
+	class VirtualFunctionCache
+	{
+	public:
+		/// <summary>Finds the first virtual function whose first bytes contain the pattern.</summary>
+		/// <param name="vtable">The address of the vtable.</param>
+		/// <param name="bytes">The bytes of the pattern.</param>
+		/// <param name="mask">The mask of the pattern, 'x' compares a byte and '?' matches any byte.</param>
+		/// <param name="range">The number of bytes of every function to search.</param>
+		/// <returns>The index in the vtable, -1 if no function matches.</returns>
+		int FindIndex(uintptr_t vtable, const char* bytes, const char* mask, size_t range)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			auto& entry = vtables[vtable];
+			if (!entry.Measured)
+			{
+				ReadFunctions(vtable, entry.Functions);
+				entry.Measured = true;
+			}
+
+			const auto key = std::make_tuple(bytes, mask, range);
+			const auto it = entry.Indices.find(key);
+			if (it != std::end(entry.Indices))
+			{
+				return it->second;
+			}
+
+			const auto index = Scan(entry.Functions, bytes, mask, range);
+			entry.Indices.emplace(key, index);
+			return index;
+		}
+
+	private:
+		/// <summary>The longest vtable which gets read, UObject has a few hundred virtual functions.</summary>
+		static constexpr size_t MaxFunctions = 4096;
+
+		struct VTable
+		{
+			bool Measured = false;
+			std::vector<uintptr_t> Functions;
+			std::map<std::tuple<const char*, const char*, size_t>, int> Indices;
+		};
+
+		/// <summary>Reads the functions of a vtable, it ends at the first slot which does not point into executable code.</summary>
+		static void ReadFunctions(uintptr_t vtable, std::vector<uintptr_t>& functions)
+		{
+			for (auto slot = reinterpret_cast<const uintptr_t*>(vtable); functions.size() < MaxFunctions; ++slot)
+			{
+				//the slot after the last function is expected to miss, it must not refresh the module map
+				int protection;
+				if (!Tools::IsPtrValid(slot, sizeof(uintptr_t), false) || !ModuleMap::GetProtection(*slot, 1, PROT_EXEC, protection, false))
+				{
+					break;
+				}
+				functions.push_back(*slot);
+			}
+		}
+
+		static int Scan(const std::vector<uintptr_t>& functions, const char* bytes, const char* mask, size_t range)
+		{
+			BytePattern pattern;
+			if (!PatternScanner::Parse(bytes, mask, pattern))
+			{
+				return -1;
+			}
+
+			for (auto i = 0u; i < functions.size(); ++i)
+			{
+				//execute only code can not be searched, the range must not leave the mapping
+				ModuleMap::Segment segment;
+				if (!ModuleMap::FindSegment(functions[i], segment, false) || (segment.Protection & PROT_READ) == 0)
+				{
+					continue;
+				}
+
+				const auto begin = reinterpret_cast<const uint8_t*>(functions[i]);
+				const auto end = reinterpret_cast<const uint8_t*>(std::min(functions[i] + range, segment.End));
+				if (PatternScanner::Find(begin, end, pattern) != nullptr)
+				{
+					return static_cast<int>(i);
+				}
+			}
+
+			return -1;
+		}
+
+		std::mutex mutex;
+		std::unordered_map<uintptr_t, VTable> vtables;
+	};
+
+	VirtualFunctionCache virtualFunctionCache;
+}
+
 void Package::GenerateClass(const UEClass& classObj)
 {
 	extern IGenerator* generator;
 
+	std::string buffer;
 	Class c;
-	c.Name = classObj.GetName();
-	c.FullName = classObj.GetFullName();
+	c.Name = arena.Store(classObj.GetNameView(buffer));
+	const auto fullName = classObj.GetFullName();
+	c.FullName = arena.Store(fullName);
 
 	//Logger::Log("Class:        %-100s - instance: 0x%P", c.Name, classObj.GetAddress());
 
-	c.NameCpp = MakeValidName(classObj.GetNameCPP());
-	c.NameCppFull = "class " + c.NameCpp;
+	c.NameCpp = arena.Store(MakeValidName(classObj.GetNameCPP()));
+	std::string nameCppFull = "class ";
+	nameCppFull += c.NameCpp;
 
 	c.Size = classObj.GetPropertySize();
 	c.InheritedSize = 0;
@@ -357,27 +748,30 @@ void Package::GenerateClass(const UEClass& classObj)
 	{
 		c.InheritedSize = offset = super.GetPropertySize();
 
-		c.NameCppFull += " : public " + MakeValidName(super.GetNameCPP());
+		nameCppFull += " : public " + MakeValidName(super.GetNameCPP());
 	}
 
-	std::vector<IGenerator::PredefinedMember> predefinedStaticMembers;
-	if (generator->GetPredefinedClassStaticMembers(c.FullName, predefinedStaticMembers))
+	c.NameCppFull = arena.Store(nameCppFull);
+
+	//the predefined members and methods belong to the generator, the model only refers to them
+	const auto predefinedStaticMembers = generator->GetPredefinedClassStaticMembers(fullName);
+	if (predefinedStaticMembers != nullptr)
 	{
-		for (auto&& prop : predefinedStaticMembers)
+		for (auto&& prop : *predefinedStaticMembers)
 		{
 			Member p;
 			p.Offset = 0;
 			p.Size = 0;
 			p.Name = prop.Name;
-			p.Type = "static " + prop.Type;
+			p.Type = arena.Intern("static " + prop.Type);
 			c.Members.push_back(std::move(p));
 		}
 	}
 
-	std::vector<IGenerator::PredefinedMember> predefinedMembers;
-	if (generator->GetPredefinedClassMembers(c.FullName, predefinedMembers))
+	const auto predefinedMembers = generator->GetPredefinedClassMembers(fullName);
+	if (predefinedMembers != nullptr)
 	{
-		for (auto&& prop : predefinedMembers)
+		for (auto&& prop : *predefinedMembers)
 		{
 			Member p;
 			p.Offset = 0;
@@ -413,89 +807,76 @@ void Package::GenerateClass(const UEClass& classObj)
 		GenerateMembers(classObj, offset, properties, c.Members);
 	}
 
-	generator->GetPredefinedClassMethods(c.FullName, c.PredefinedMethods);
+	AddPredefinedMethods(fullName, c.PredefinedMethods);
     
-	if (generator->ShouldUseStrings())
-	{
-		c.PredefinedMethods.push_back(IGenerator::PredefinedMethod::Inline(tfm::format(R"(	static UClass* StaticClass()
-	{
-        static UClass *pStaticClass = 0;
-        if (!pStaticClass)
-            pStaticClass = UObject::FindClass(%s);
-		return pStaticClass;
-	})", generator->ShouldXorStrings() ? tfm::format("_xor_(\"%s\")", c.FullName) : tfm::format("\"%s\"", c.FullName))));
-	}
-	else
-	{
-		c.PredefinedMethods.push_back(IGenerator::PredefinedMethod::Inline(tfm::format(R"(	static UClass* StaticClass()
+	c.PredefinedMethods.push_back({ std::string_view(), arena.Format(R"(	static UClass* StaticClass()
 	{
-		static auto ptr = UObject::GetObjectCasted<UClass>(%d);
-		return ptr;
-	})", classObj.GetIndex())));
-	}
+		return reinterpret_cast<UClass*>(%s_Objects[%zu]);
+	})", GetObjectSlotsPrefix().c_str(), AddObjectSlot(classObj, c.FullName)), IGenerator::PredefinedMethod::Type::Inline });
 
 	GenerateMethods(classObj, c.Methods);
 
 	//search virtual functions
 	IGenerator::VirtualFunctionPatterns patterns;
-//	if (generator->GetVirtualFunctionPatterns(c.FullName, patterns))
-//	{
-//		const auto vtable = *reinterpret_cast<uintptr_t**>(classObj.GetAddress());
-//
-//		size_t methodCount = 0;
-//		while (true)
-//		{
-//			MEMORY_BASIC_INFORMATION mbi;
-//			auto res = VirtualQuery(reinterpret_cast<const void*>(vtable[methodCount]), &mbi, sizeof(mbi));
-//			if (res == 0 || (mbi.Protect != PAGE_EXECUTE_READWRITE && mbi.Protect != PAGE_EXECUTE_READ))
-//			{
-//				break;
-//			}
-//			++methodCount;
-//		}
-//
-//		for (auto&& pattern : patterns)
-//		{
-//			for (auto i = 0u; i < methodCount; ++i)
-//			{
-//				if (vtable[i] != 0 && FindPattern(vtable[i], std::get<2>(pattern), reinterpret_cast<const unsigned char*>(std::get<0>(pattern)), std::get<1>(pattern)) != -1)
-//				{
-//					c.PredefinedMethods.push_back(IGenerator::PredefinedMethod::Inline(tfm::format(std::get<3>(pattern), i)));
-//					break;
-//				}
-//			}
-//		}
-//	}
+	if (generator->GetVirtualFunctionPatterns(fullName, patterns) && Tools::IsPtrValid(classObj.GetAddress()))
+	{
+		const auto vtable = *static_cast<const uintptr_t*>(classObj.GetAddress());
+
+		for (auto&& pattern : patterns)
+		{
+			const auto index = virtualFunctionCache.FindIndex(vtable, std::get<0>(pattern), std::get<1>(pattern), std::get<2>(pattern));
+			if (index != -1)
+			{
+				c.PredefinedMethods.push_back({ std::string_view(), arena.Store(tfm::format(std::get<3>(pattern), index)), IGenerator::PredefinedMethod::Type::Inline });
+			}
+		}
+	}
 
 	classes.emplace_back(std::move(c));
 }
 
-Package::Member Package::CreatePadding(size_t id, size_t offset, size_t size, std::string reason)
+void Package::AddPredefinedMethods(const std::string& fullName, std::vector<PredefinedMethod>& methods) const
+{
+	extern IGenerator* generator;
+
+	const auto predefinedMethods = generator->GetPredefinedClassMethods(fullName);
+	if (predefinedMethods != nullptr)
+	{
+		for (auto&& m : *predefinedMethods)
+		{
+			methods.push_back({ m.Signature, m.Body, m.MethodType });
+		}
+	}
+}
+
+Package::Member Package::CreatePadding(size_t id, size_t offset, size_t size, std::string_view reason)
 {
 	Member ss;
-	ss.Name = tfm::format("UnknownData%02d[0x%X]", id, size);
+	ss.Name = arena.Format("UnknownData%02zu[0x%zX]", id, size);
 	ss.Type = "unsigned char";
 	ss.Offset = offset;
 	ss.Size = size;
-	ss.Comment = std::move(reason);
+	ss.Comment = reason;
 	return ss;
 }
 
-Package::Member Package::CreateBitfieldPadding(size_t id, size_t offset, std::string type, size_t bits)
+Package::Member Package::CreateBitfieldPadding(size_t id, size_t offset, std::string_view type, size_t bits)
 {
 	Member ss;
-	ss.Name = tfm::format("UnknownData%02d : %d", id, bits);
-	ss.Type = std::move(type);
+	ss.Name = arena.Format("UnknownData%02zu : %zu", id, bits);
+	ss.Type = type;
 	ss.Offset = offset;
 	ss.Size = 1;
 	return ss;
 }
 
-void Package::GenerateMembers(const UEStruct& structObj, size_t offset, const std::vector<UEProperty>& properties, std::vector<Member>& members) const
+void Package::GenerateMembers(const UEStruct& structObj, size_t offset, const std::vector<UEProperty>& properties, std::vector<Member>& members)
 {
 	extern IGenerator* generator;
 
-	std::unordered_map<std::string, size_t> uniqueMemberNames;
+	std::unordered_map<std::string_view, size_t> uniqueMemberNames;
+	std::string name;
+	std::string buffer;
 	size_t unknownDataCounter = 0;
 	UEBoolProperty previousBitfieldProperty;
 
@@ -516,23 +897,27 @@ void Package::GenerateMembers(const UEStruct& structObj, size_t offset, const st
 			sp.Offset = prop.GetOffset();
 			sp.Size = info.Size;
 
-			sp.Type = info.CppType;
-			sp.Name = MakeValidName(prop.GetName());
+			sp.Type = arena.Intern(info.CppType);
 
-			const auto it = uniqueMemberNames.find(sp.Name);
+			name.assign(prop.GetNameView(buffer));
+			name = MakeValidName(std::move(name));
+
+			std::string_view uniqueName;
+			const auto it = uniqueMemberNames.find(name);
 			if (it == std::end(uniqueMemberNames))
 			{
-				uniqueMemberNames[sp.Name] = 1;
+				uniqueName = arena.Store(name);
+				uniqueMemberNames[uniqueName] = 1;
 			}
 			else
 			{
-				++uniqueMemberNames[sp.Name];
-				sp.Name += tfm::format("%02d", it->second);
+				++it->second;
+				name += tfm::format("%02d", it->second);
 			}
 
 			if (prop.GetArrayDim() > 1)
 			{
-				sp.Name += tfm::format("[0x%X]", prop.GetArrayDim());
+				name += tfm::format("[0x%X]", prop.GetArrayDim());
 			}
 
 			if (prop.IsA<UEBoolProperty>() && prop.Cast<UEBoolProperty>().IsBitfield())
@@ -544,21 +929,21 @@ void Package::GenerateMembers(const UEStruct& structObj, size_t offset, const st
 				{
 					if (missingBits[0] > 0)
 					{
-						members.emplace_back(CreateBitfieldPadding(unknownDataCounter++, previousBitfieldProperty.GetOffset(), info.CppType, missingBits[0]));
+						members.emplace_back(CreateBitfieldPadding(unknownDataCounter++, previousBitfieldProperty.GetOffset(), sp.Type, missingBits[0]));
 					}
 					if (missingBits[1] > 0)
 					{
-						members.emplace_back(CreateBitfieldPadding(unknownDataCounter++, sp.Offset, info.CppType, missingBits[1]));
+						members.emplace_back(CreateBitfieldPadding(unknownDataCounter++, sp.Offset, sp.Type, missingBits[1]));
 					}
 				}
 				else if(missingBits[0] > 0)
 				{
-					members.emplace_back(CreateBitfieldPadding(unknownDataCounter++, sp.Offset, info.CppType, missingBits[0]));
+					members.emplace_back(CreateBitfieldPadding(unknownDataCounter++, sp.Offset, sp.Type, missingBits[0]));
 				}
 
 				previousBitfieldProperty = boolProp;
 
-				sp.Name += " : 1";
+				name += " : 1";
 			}
 			else
 			{
@@ -566,7 +951,8 @@ void Package::GenerateMembers(const UEStruct& structObj, size_t offset, const st
 			}
 
 			sp.Flags = static_cast<size_t>(prop.GetPropertyFlags());
-			sp.FlagsString = StringifyFlags(prop.GetPropertyFlags());
+			sp.FlagsString = arena.Intern(StringifyFlags(prop.GetPropertyFlags()));
+			sp.Name = name.size() == uniqueName.size() ? uniqueName : arena.Store(name);
 
 			members.emplace_back(std::move(sp));
 
@@ -579,7 +965,7 @@ void Package::GenerateMembers(const UEStruct& structObj, size_t offset, const st
 		else
 		{
 			const auto size = prop.GetElementSize() * prop.GetArrayDim();
-			members.emplace_back(CreatePadding(unknownDataCounter++, offset, size, "UNKNOWN PROPERTY: " + prop.GetFullName()));
+			members.emplace_back(CreatePadding(unknownDataCounter++, offset, size, arena.Store("UNKNOWN PROPERTY: " + prop.GetFullName())));
 		}
 
 		offset = prop.GetOffset() + prop.GetElementSize() * prop.GetArrayDim();
@@ -622,12 +1008,14 @@ bool Package::Method::Parameter::MakeType(UEPropertyFlags flags, Type& type)
     return true;
 }
 
-void Package::GenerateMethods(const UEClass& classObj, std::vector<Method>& methods) const
+void Package::GenerateMethods(const UEClass& classObj, std::vector<Method>& methods)
 {
 	extern IGenerator* generator;
 
 	//some classes (AnimBlueprintGenerated...) have multiple members with the same name, so filter them out
-	std::unordered_set<std::string> uniqueMethods;
+	std::unordered_set<std::string_view> uniqueMethods;
+	std::string name;
+	std::string buffer;
 
 	for (auto prop = classObj.GetChildren().Cast<UEProperty>(); prop.IsValid(); prop = prop.GetNext().Cast<UEProperty>())
 	{
@@ -635,24 +1023,29 @@ void Package::GenerateMethods(const UEClass& classObj, std::vector<Method>& meth
 		{
 			auto function = prop.Cast<UEFunction>();
 
-			Method m;
-			m.Index = function.GetIndex();
-			m.FullName = function.GetFullName();
-			m.Name = MakeValidName(function.GetName());
-
-			if (uniqueMethods.find(m.FullName) != std::end(uniqueMethods))
+			const auto fullName = function.GetFullNameView(buffer);
+			if (uniqueMethods.find(fullName) != std::end(uniqueMethods))
 			{
 				continue;
 			}
+
+			Method m;
+			m.Index = function.GetIndex();
+			m.FullName = arena.Store(fullName);
+			name.assign(function.GetNameView(buffer));
+			m.Name = arena.Store(MakeValidName(std::move(name)));
+
 			uniqueMethods.insert(m.FullName);
 
+			m.Slot = AddObjectSlot(function, m.FullName);
+
 			m.IsNative = function.GetFunctionFlags() & UEFunctionFlags::Native;
 			m.IsStatic = function.GetFunctionFlags() & UEFunctionFlags::Static;
-			m.FlagsString = StringifyFlags(function.GetFunctionFlags());
+			m.FlagsString = arena.Intern(StringifyFlags(function.GetFunctionFlags()));
 
 			std::vector<std::pair<UEProperty, Method::Parameter>> parameters;
 
-			std::unordered_map<std::string, size_t> unique;
+			std::unordered_map<std::string_view, size_t> unique;
 			for (auto param = function.GetChildren().Cast<UEProperty>(); param.IsValid(); param = param.GetNext().Cast<UEProperty>())
 			{
 				if (param.GetElementSize() == 0)
@@ -674,33 +1067,31 @@ void Package::GenerateMethods(const UEClass& classObj, std::vector<Method>& meth
 					}
 
 					p.PassByReference = false;
-					p.Name = MakeValidName(param.GetName());
+					name.assign(param.GetNameView(buffer));
+					name = MakeValidName(std::move(name));
 
-					const auto it = unique.find(p.Name);
+					const auto it = unique.find(name);
 					if (it == std::end(unique))
 					{
+						p.Name = arena.Store(name);
 						unique[p.Name] = 1;
 					}
 					else
 					{
-						++unique[p.Name];
+						++it->second;
 
-						p.Name += tfm::format("%02d", it->second);
+						p.Name = arena.Format("%s%02zu", name.c_str(), it->second);
 					}
 
-					p.FlagsString = StringifyFlags(param.GetPropertyFlags());
+					p.FlagsString = arena.Intern(StringifyFlags(param.GetPropertyFlags()));
 
-					p.CppType = info.CppType;
-					if (param.IsA<UEBoolProperty>())
-					{
-						p.CppType = generator->GetOverrideType("bool");
-					}
+					p.CppType = param.IsA<UEBoolProperty>() ? arena.Intern(generator->GetOverrideType("bool")) : arena.Intern(info.CppType);
 					switch (p.ParamType)
 					{
 						case Type::Default:
 							if (prop.GetArrayDim() > 1)
 							{
-								p.CppType = p.CppType + "*";
+								p.CppType = arena.Intern(std::string(p.CppType) + "*");
 							}
 							else if (info.CanBeReference)
 							{
@@ -729,7 +1120,7 @@ void Package::SaveStructs(std::string path) const
 {
 	extern IGenerator* generator;
 
-	std::ofstream os(path + "/" + GenerateFileName(FileContentType::Structs, *this));
+	std::ostringstream os;
 
 	PrintFileHeader(os, true);
 
@@ -756,16 +1147,24 @@ void Package::SaveStructs(std::string path) const
 	}
 
 	PrintFileFooter(os);
+
+	OutputWriter::Write(path + "/" + GenerateFileName(FileContentType::Structs, *this), os.str());
 }
 
 void Package::SaveClasses(std::string path) const
 {
 	extern IGenerator* generator;
 
-	std::ofstream os(path + "/" + GenerateFileName(FileContentType::Classes, *this));
+	std::ostringstream os;
 
 	PrintFileHeader(os, true);
 
+	if (!objectSlots.empty())
+	{
+		//filled by Init()
+		tfm::format(os, "extern UObject* %s_Objects[];\n\n", GetObjectSlotsPrefix());
+	}
+
 	if (!classes.empty())
 	{
 		PrintSectionHeader(os, "Classes");
@@ -773,6 +1172,8 @@ void Package::SaveClasses(std::string path) const
 	}
 
 	PrintFileFooter(os);
+
+	OutputWriter::Write(path + "/" + GenerateFileName(FileContentType::Classes, *this), os.str());
 }
 
 void Package::SaveFunctions(std::string path) const
@@ -786,10 +1187,42 @@ void Package::SaveFunctions(std::string path) const
 		SaveFunctionParameters(path);
 	}
 
-	std::ofstream os(path +  "/" + GenerateFileName(FileContentType::Functions, *this));
+	std::ostringstream os;
 
 	PrintFileHeader(os, { "\"../SDK.hpp\"" }, false);
 
+	if (!objectSlots.empty())
+	{
+		PrintSectionHeader(os, "Object Slots");
+
+		const auto prefix = GetObjectSlotsPrefix();
+
+		tfm::format(os, "UObject* %s_Objects[%d];\n\n", prefix, objectSlots.size());
+
+		tfm::format(os, "extern const FObjectSlot %s_ObjectSlots[] =\n{\n", prefix);
+		for (auto&& slot : objectSlots)
+		{
+			if (generator->ShouldUseStrings())
+			{
+				//Init() compares the full name, objects with the same hash must not take the slot; xor encoded strings
+				//must not appear in the binary, those slots are matched by the hash alone
+				if (generator->ShouldXorStrings())
+				{
+					tfm::format(os, "\t{ 0x%016Xull }, // %s\n", Fnv1a::Hash(slot.FullName), slot.FullName);
+				}
+				else
+				{
+					tfm::format(os, "\t{ 0x%016Xull, \"%s\" },\n", Fnv1a::Hash(slot.FullName), slot.FullName);
+				}
+			}
+			else
+			{
+				tfm::format(os, "\t{ 0x%016Xull, %d, %d }, // %s\n", Fnv1a::Hash(slot.FullName), slot.Index, slot.SerialNumber, slot.FullName);
+			}
+		}
+		os << "};\n\n";
+	}
+
 	PrintSectionHeader(os, "Functions");
 
 	for (auto&& s : scriptStructs)
@@ -834,18 +1267,21 @@ void Package::SaveFunctions(std::string path) const
 	}
 
 	PrintFileFooter(os);
+
+	OutputWriter::Write(path + "/" + GenerateFileName(FileContentType::Functions, *this), os.str());
 }
 
 void Package::SaveFunctionParameters(std::string path) const
 {
 	using namespace cpplinq;
 
-	std::ofstream os(path + "/" + GenerateFileName(FileContentType::FunctionParameters, *this));
+	std::ostringstream os;
 
 	PrintFileHeader(os, { "\"../SDK.hpp\"" }, true);
 
 	PrintSectionHeader(os, "Parameters");
 
+	std::string field;
 	for (auto&& c : classes)
 	{
 		for (auto&& m : c.Methods)
@@ -854,13 +1290,16 @@ void Package::SaveFunctionParameters(std::string path) const
 			tfm::format(os, "struct %s_%s_Params\n{\n", c.NameCpp, m.Name);
 			for (auto&& param : m.Parameters)
 			{
-				tfm::format(os, "\t%-50s %-58s// (%s)\n", param.CppType, param.Name + ";", param.FlagsString);
+				field.assign(param.Name).append(1, ';');
+				tfm::format(os, "\t%-50s %-58s// (%s)\n", param.CppType, field, param.FlagsString);
 			}
 			os << "};\n\n";
 		}
 	}
 
 	PrintFileFooter(os);
+
+	OutputWriter::Write(path + "/" + GenerateFileName(FileContentType::FunctionParameters, *this), os.str());
 }
 
 void Package::PrintConstant(std::ostream& os, const std::pair<std::string, std::string>& c) const
@@ -896,14 +1335,25 @@ void Package::PrintStruct(std::ostream& os, const ScriptStruct& ss) const
 	os << ss.NameCppFull << "\n{\n";
 
 	//Member
-	os << (from(ss.Members)
-		>> select([](auto&& m) {
-				return tfm::format("\t%-50s %-58s// 0x%04X(0x%04X)", m.Type, m.Name + ";", m.Offset, m.Size)
-					+ (!m.Comment.empty() ? " " + m.Comment : "")
-					+ (!m.FlagsString.empty() ? " (" + m.FlagsString + ")" : "");
-			})
-		>> concatenate("\n"))
-		<< "\n";
+	std::string field;
+	for (auto&& m : ss.Members)
+	{
+		field.assign(m.Name).append(1, ';');
+		tfm::format(os, "\t%-50s %-58s// 0x%04X(0x%04X)", m.Type, field, m.Offset, m.Size);
+		if (!m.Comment.empty())
+		{
+			os << " " << m.Comment;
+		}
+		if (!m.FlagsString.empty())
+		{
+			os << " (" << m.FlagsString << ")";
+		}
+		os << "\n";
+	}
+	if (ss.Members.empty())
+	{
+		os << "\n";
+	}
 
 	//Predefined Methods
 	if (!ss.PredefinedMethods.empty())
@@ -943,9 +1393,11 @@ void Package::PrintClass(std::ostream& os, const Class& c) const
 	os << c.NameCppFull << "\n{\npublic:\n";
 
 	//Member
+	std::string field;
 	for (auto&& m : c.Members)
 	{
-		tfm::format(os, "\t%-50s %-58s// 0x%04X(0x%04X)", m.Type, m.Name + ";", m.Offset, m.Size);
+		field.assign(m.Name).append(1, ';');
+		tfm::format(os, "\t%-50s %-58s// 0x%04X(0x%04X)", m.Type, field, m.Offset, m.Size);
 		if (!m.Comment.empty())
 		{
 			os << " " << m.Comment;
@@ -1030,7 +1482,7 @@ std::string Package::BuildMethodSignature(const Method& m, const Class& c, bool
 	ss << (from(m.Parameters)
 		>> where([](auto&& param) { return param.ParamType != Type::Return; })
 		>> orderby([](auto&& param) { return param.ParamType; })
-		>> select([](auto&& param) { return (param.PassByReference ? "const " : "") + param.CppType + (param.PassByReference ? "& " : param.ParamType == Type::Out ? "* " : " ") + param.Name; })
+		>> select([](auto&& param) { return std::string(param.PassByReference ? "const " : "").append(param.CppType).append(param.PassByReference ? "& " : param.ParamType == Type::Out ? "* " : " ").append(param.Name); })
 		>> concatenate(", "));
 	ss << ")";
 
@@ -1047,29 +1499,7 @@ std::string Package::BuildMethodBody(const Class& c, const Method& m) const
 	std::ostringstream ss;
     
 	//Function Pointer
-	ss << "{\n\tstatic UFunction *pFunc = 0;";
-    ss << "\n\tif (!pFunc)";
-    ss << "\n\t\tpFunc ";
-
-	if (generator->ShouldUseStrings())
-	{
-		ss << " = UObject::FindObject<UFunction>(";
-
-		if (generator->ShouldXorStrings())
-		{
-			ss << "_xor_(\"" << m.FullName << "\")";
-		}
-		else
-		{
-			ss << "\"" << m.FullName << "\"";
-		}
-
-		ss << ");\n\n";
-	}
-	else
-	{
-		ss << " = UObject::GetObjectCasted<UFunction>(" << m.Index << ");\n\n";
-	}
+	ss << "{\n\tauto pFunc = " << tfm::format("static_cast<UFunction*>(%s_Objects[%d]);\n\n", GetObjectSlotsPrefix(), m.Slot);
 
 	//Parameters
 	if (generator->ShouldGenerateFunctionParametersFile())
@@ -1,22 +1,62 @@
 #pragma once
 
 #include <vector>
+#include <memory>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 
 #include "UE4/GenericTypes.hpp"
+#include "Manifest.hpp"
+#include "StringArena.hpp"
 
 
 
+/// <summary>
+/// The type objects (enums, constants, classes and script structs) of all packages,
+/// collected with a single scan of the objects store.
+/// </summary>
+class PackageIndex
+{
+public:
+	/// <summary>Scans the objects store.</summary>
+	PackageIndex();
+
+	/// <summary>Gets all packages in the order they are first referenced by an object.</summary>
+	/// <returns>The package objects.</returns>
+	const std::vector<UEObject>& GetPackages() const { return packages; }
+
+	/// <summary>Gets the type objects of the package in the order of the objects store.</summary>
+	/// <param name="index">The index of the package in <see cref="GetPackages()" />.</param>
+	/// <returns>The type objects.</returns>
+	const std::vector<UEObject>& GetTypeObjects(size_t index) const { return typeObjects[index]; }
+
+private:
+	std::vector<UEObject> packages;
+	std::vector<std::vector<UEObject>> typeObjects;
+};
+
+/// <summary>
+/// What the package order and the SDK header need of a saved package. The package with its classes, structs, enums and
+/// their members and methods is released as soon as its files are written, only the records stay until the end of the run.
+/// </summary>
+struct PackageRecord
+{
+	UEObject PackageObj;
+	std::string Name;
+	uint64_t Hash;
+	/// <summary>The number of object slots, see <see cref="Package::GetObjectSlotsNum" />.</summary>
+	size_t ObjectSlotsNum;
+	/// <summary>The packages the generated files include.</summary>
+	std::vector<UEObject> Dependencies;
+};
+
 class Package
 {
 	friend struct std::hash<Package>;
-	friend struct PackageDependencyComparer;
 	friend bool operator==(const Package& lhs, const Package& rhs);
 
 public:
-	static std::unordered_map<UEObject, const Package*> PackageMap;
-
 	/// <summary>
 	/// Constructor.
 	/// </summary>
@@ -28,15 +68,53 @@ public:
 	/// <summary>
 	/// Process the classes the package contains.
 	/// </summary>
-	void Process(std::unordered_map<UEObject, bool>& processedObjects);
+	/// <param name="typeObjects">The enums, constants, classes and script structs of the package.</param>
+	void Process(const std::vector<UEObject>& typeObjects, std::unordered_map<UEObject, bool>& processedObjects);
 
 	/// <summary>
 	/// Saves the package classes as C++ code.
 	/// Files are only generated if there is code present or the generator forces the genertion of empty files.
+	/// Files which were generated from the same types by a previous run are kept.
 	/// </summary>
 	/// <param name="path">The path to save to.</param>
+	/// <param name="previous">The manifest of the previous run.</param>
 	/// <returns>true if files got saved, else false.</returns>
-	bool Save(std::string path) const;
+	bool Save(std::string path, const Manifest& previous) const;
+
+	/// <summary>
+	/// Gets the hash of the processed types and methods of the package.
+	/// Two packages with the same hash generate the same files.
+	/// </summary>
+	/// <returns>The hash.</returns>
+	uint64_t GetHash() const { return hash; }
+
+	/// <summary>
+	/// Gets the number of object slots of the package. Every generated StaticClass() and function wrapper
+	/// loads its UClass/UFunction from a slot of the package table which the generated Init() fills.
+	/// </summary>
+	/// <returns>The number of slots.</returns>
+	size_t GetObjectSlotsNum() const { return objectSlots.size(); }
+
+	/// <summary>Gets the prefix of the generated object slot tables of the package.</summary>
+	/// <returns>The prefix.</returns>
+	std::string GetObjectSlotsPrefix() const;
+
+	/// <summary>Gets the prefix of the generated object slot tables of a package.</summary>
+	/// <param name="name">The name of the package.</param>
+	/// <returns>The prefix.</returns>
+	static std::string GetObjectSlotsPrefix(std::string name);
+
+	/// <summary>Creates the record which outlives the package once its files are saved.</summary>
+	/// <returns>The record.</returns>
+	PackageRecord GetRecord() const;
+
+	/// <summary>
+	/// Sorts the packages so every package comes after the packages it depends on.
+	/// Independent packages keep their original order. Dependency cycles are logged
+	/// and broken by emitting the package of the cycle which comes first in the original order.
+	/// </summary>
+	/// <param name="packages">[in,out] The records of the packages to sort.</param>
+	static void SortByDependencies(std::vector<PackageRecord>& packages);
 
 private:
 	bool AddDependency(const UEObject& package) const;
@@ -102,7 +180,42 @@ private:
 	/// <param name="path">The path to save to.</param>
 	void SaveFunctionParameters(std::string path) const;
 
+	/// <summary>
+	/// Checks if all files of the package exist.
+	/// </summary>
+	/// <param name="path">The path to check.</param>
+	/// <returns>true if all files exist.</returns>
+	bool FilesExist(const std::string& path) const;
+
+	/// <summary>
+	/// Computes the hash of everything the files of the package are generated from.
+	/// </summary>
+	/// <returns>The hash.</returns>
+	uint64_t ComputeHash() const;
+
+	struct ObjectSlot
+	{
+		std::string_view FullName;
+		size_t Index;
+		int32_t SerialNumber;
+	};
+
+	/// <summary>
+	/// Adds a slot for the object to the table of the package.
+	/// </summary>
+	/// <param name="obj">The class or function object.</param>
+	/// <param name="fullName">The full name of the object, stored in the arena.</param>
+	/// <returns>The index of the slot.</returns>
+	size_t AddObjectSlot(const UEObject& obj, std::string_view fullName);
+
 	UEObject packageObj;
+	/// <summary>
+	/// Holds the strings of the generated model below. The model refers to them (and to the strings of the generator)
+	/// by views, so all of them are freed at once when the saved package is destroyed.
+	/// </summary>
+	StringArena arena;
+	uint64_t hash = 0;
+	std::vector<ObjectSlot> objectSlots;
 	mutable std::unordered_set<UEObject> dependencies;
 
 	/// <summary>
@@ -116,9 +229,9 @@ private:
 
 	struct Enum
 	{
-		std::string Name;
-		std::string FullName;
-		std::vector<std::string> Values;
+		std::string_view Name;
+		std::string_view FullName;
+		std::vector<std::string_view> Values;
 	};
 
 	/// <summary>
@@ -132,16 +245,16 @@ private:
 
 	struct Member
 	{
-		std::string Name;
-		std::string Type;
+		std::string_view Name;
+		std::string_view Type;
 
 		size_t Offset;
 		size_t Size;
 
 		size_t Flags;
-		std::string FlagsString;
+		std::string_view FlagsString;
 
-		std::string Comment;
+		std::string_view Comment;
 	};
 
 	/// <summary>
@@ -150,19 +263,19 @@ private:
 	/// <param name="id">The unique name identifier.</param>
 	/// <param name="offset">The offset.</param>
 	/// <param name="size">The size.</param>
-	/// <param name="reason">The reason.</param>
+	/// <param name="reason">The reason, must outlive the member.</param>
 	/// <returns>A padding member.</returns>
-	static Member CreatePadding(size_t id, size_t offset, size_t size, std::string reason);
+	Member CreatePadding(size_t id, size_t offset, size_t size, std::string_view reason);
 
 	/// <summary>
 	/// Generates a padding member.
 	/// </summary>
 	/// <param name="id">The unique name identifier.</param>
 	/// <param name="offset">The offset.</param>
-	/// <param name="size">The size.</param>
-	/// <param name="reason">The reason.</param>
+	/// <param name="type">The type, must outlive the member.</param>
+	/// <param name="bits">The number of bits.</param>
 	/// <returns>A padding member.</returns>
-	static Member CreateBitfieldPadding(size_t id, size_t offset, std::string type, size_t bits);
+	Member CreateBitfieldPadding(size_t id, size_t offset, std::string_view type, size_t bits);
 
 	/// <summary>
 	/// Generates the members of a struct or class.
@@ -171,23 +284,41 @@ private:
 	/// <param name="offset">The start offset.</param>
 	/// <param name="properties">The properties describing the members.</param>
 	/// <param name="members">[out] The members of the struct or class.</param>
-	void GenerateMembers(const UEStruct& structObj, size_t offset, const std::vector<UEProperty>& properties, std::vector<Member>& members) const;
+	void GenerateMembers(const UEStruct& structObj, size_t offset, const std::vector<UEProperty>& properties, std::vector<Member>& members);
+
+	/// <summary>
+	/// A method of <see cref="IGenerator::PredefinedMethod" /> which refers to the strings of the generator
+	/// or, for the generated methods, of the arena.
+	/// </summary>
+	struct PredefinedMethod
+	{
+		std::string_view Signature;
+		std::string_view Body;
+		IGenerator::PredefinedMethod::Type MethodType;
+	};
 
 	struct ScriptStruct
 	{
-		std::string Name;
-		std::string FullName;
-		std::string NameCpp;
-		std::string NameCppFull;
+		std::string_view Name;
+		std::string_view FullName;
+		std::string_view NameCpp;
+		std::string_view NameCppFull;
 
 		size_t Size;
 		size_t InheritedSize;
 
 		std::vector<Member> Members;
 
-		std::vector<IGenerator::PredefinedMethod> PredefinedMethods;
+		std::vector<PredefinedMethod> PredefinedMethods;
 	};
 
+	/// <summary>
+	/// Adds the predefined methods the generator has for a struct or class.
+	/// </summary>
+	/// <param name="fullName">The full name of the struct or class.</param>
+	/// <param name="methods">[in,out] The predefined methods of the struct or class.</param>
+	void AddPredefinedMethods(const std::string& fullName, std::vector<PredefinedMethod>& methods) const;
+
 	/// <summary>
 	/// Print the C++ code of the structure.
 	/// </summary>
@@ -210,9 +341,9 @@ private:
 
 			Type ParamType;
 			bool PassByReference;
-			std::string CppType;
-			std::string Name;
-			std::string FlagsString;
+			std::string_view CppType;
+			std::string_view Name;
+			std::string_view FlagsString;
 
 			/// <summary>
 			/// Generates a valid type of the property flags.
@@ -224,10 +355,11 @@ private:
 		};
 
 		size_t Index;
-		std::string Name;
-		std::string FullName;
+		size_t Slot;
+		std::string_view Name;
+		std::string_view FullName;
 		std::vector<Parameter> Parameters;
-		std::string FlagsString;
+		std::string_view FlagsString;
 		bool IsNative;
 		bool IsStatic;
 	};
@@ -237,11 +369,11 @@ private:
 	/// </summary>
 	/// <param name="classObj">The class object.</param>
 	/// <param name="methods">[out] The methods of the class.</param>
-	void GenerateMethods(const UEClass& classObj, std::vector<Method>& methods) const;
+	void GenerateMethods(const UEClass& classObj, std::vector<Method>& methods);
 
 	struct Class : ScriptStruct
 	{
-		std::vector<std::string> VirtualFunctions;
+		std::vector<std::string_view> VirtualFunctions;
 		std::vector<Method> Methods;
 	};
 
@@ -285,46 +417,3 @@ namespace std
 
 inline bool operator==(const Package& lhs, const Package& rhs) { return rhs.packageObj.GetAddress() == lhs.packageObj.GetAddress(); }
 inline bool operator!=(const Package& lhs, const Package& rhs) { return !(lhs == rhs); }
-
-struct PackageDependencyComparer
-{
-	bool operator()(const std::unique_ptr<Package>& lhs, const std::unique_ptr<Package>& rhs) const
-	{
-		return operator()(*lhs, *rhs);
-	}
-
-	bool operator()(const Package* lhs, const Package* rhs) const
-	{
-		return operator()(*lhs, *rhs);
-	}
-
-	bool operator()(const Package& lhs, const Package& rhs) const
-	{
-		if (rhs.dependencies.empty())
-		{
-			return false;
-		}
-
-		if (std::find(std::begin(rhs.dependencies), std::end(rhs.dependencies), lhs.packageObj) != std::end(rhs.dependencies))
-		{
-			return true;
-		}
-
-		for (const auto dep : rhs.dependencies)
-		{
-			const auto package = Package::PackageMap[dep];
-			if (package == nullptr)
-			{
-				// Missing package, should not occur...
-				continue;
-			}
-
-			if (operator()(lhs, *package))
-			{
-				return true;
-			}
-		}
-
-		return false;
-	}
-};
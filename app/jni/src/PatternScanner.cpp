@@ -0,0 +1,513 @@
+#include "PatternScanner.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+#include <sys/mman.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+#include "Tools.h"
+
+namespace
+{
+	constexpr size_t NoAnchor = static_cast<size_t>(-1);
+
+	using FindFunction = const uint8_t* (*)(const uint8_t* begin, const uint8_t* end, const BytePattern& pattern, size_t first, size_t second);
+
+	bool ParseNibble(char c, uint8_t& value, uint8_t& mask)
+	{
+		if (c == '?') { value = 0; mask = 0; }
+		else if (c >= '0' && c <= '9') { value = c - '0'; mask = 0xF; }
+		else if (c >= 'a' && c <= 'f') { value = c - 'a' + 10; mask = 0xF; }
+		else if (c >= 'A' && c <= 'F') { value = c - 'A' + 10; mask = 0xF; }
+		else return false;
+		return true;
+	}
+
+	bool Matches(const uint8_t* data, const BytePattern& pattern)
+	{
+		for (auto i = 0u; i < pattern.Bytes.size(); ++i)
+		{
+			if ((data[i] & pattern.Mask[i]) != pattern.Bytes[i])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/// <summary>
+	/// Chooses the two bytes the search compares first. Only complete bytes qualify, 0x00 and 0xFF are the most frequent
+	/// bytes of code and data so they are only used if the pattern has no other byte.
+	/// </summary>
+	void ChooseAnchors(const BytePattern& pattern, size_t& first, size_t& second)
+	{
+		first = second = NoAnchor;
+		for (auto pass = 0; pass < 2 && first == NoAnchor; ++pass)
+		{
+			for (auto i = 0u; i < pattern.Bytes.size(); ++i)
+			{
+				if (pattern.Mask[i] != 0xFF || (pass == 0 && (pattern.Bytes[i] == 0x00 || pattern.Bytes[i] == 0xFF)))
+				{
+					continue;
+				}
+				if (first == NoAnchor)
+				{
+					first = i;
+				}
+				second = i;
+			}
+		}
+	}
+
+	/// <summary>Checks every position, for patterns without a complete byte.</summary>
+	const uint8_t* FindMasked(const uint8_t* begin, const uint8_t* end, const BytePattern& pattern)
+	{
+		for (auto it = begin; it + pattern.Bytes.size() <= end; ++it)
+		{
+			if (Matches(it, pattern))
+			{
+				return it;
+			}
+		}
+		return nullptr;
+	}
+
+	const uint8_t* FindScalar(const uint8_t* begin, const uint8_t* end, const BytePattern& pattern, size_t first, size_t)
+	{
+		const auto size = pattern.Bytes.size();
+		if (static_cast<size_t>(end - begin) < size)
+		{
+			return nullptr;
+		}
+
+		const auto last = end - size;
+		for (auto it = begin; it <= last; ++it)
+		{
+			const auto anchor = static_cast<const uint8_t*>(memchr(it + first, pattern.Bytes[first], last - it + 1));
+			if (anchor == nullptr)
+			{
+				return nullptr;
+			}
+			it = anchor - first;
+			if (Matches(it, pattern))
+			{
+				return it;
+			}
+		}
+		return nullptr;
+	}
+
+#if defined(__SSE2__)
+	const uint8_t* FindSse2(const uint8_t* begin, const uint8_t* end, const BytePattern& pattern, size_t first, size_t second)
+	{
+		constexpr size_t Width = 16;
+
+		const auto size = pattern.Bytes.size();
+		const auto firstByte = _mm_set1_epi8(static_cast<char>(pattern.Bytes[first]));
+		const auto secondByte = _mm_set1_epi8(static_cast<char>(pattern.Bytes[second]));
+
+		//both loads stay in the range as long as a whole pattern fits behind the last position of the block
+		auto it = begin;
+		for (; static_cast<size_t>(end - it) >= size + Width - 1; it += Width)
+		{
+			const auto equal = _mm_and_si128(
+				_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(it + first)), firstByte),
+				_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(it + second)), secondByte)
+			);
+			for (auto bits = static_cast<uint32_t>(_mm_movemask_epi8(equal)); bits != 0; bits &= bits - 1)
+			{
+				const auto candidate = it + __builtin_ctz(bits);
+				if (Matches(candidate, pattern))
+				{
+					return candidate;
+				}
+			}
+		}
+		return FindScalar(it, end, pattern, first, second);
+	}
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+	__attribute__((target("avx2")))
+	const uint8_t* FindAvx2(const uint8_t* begin, const uint8_t* end, const BytePattern& pattern, size_t first, size_t second)
+	{
+		constexpr size_t Width = 32;
+
+		const auto size = pattern.Bytes.size();
+		const auto firstByte = _mm256_set1_epi8(static_cast<char>(pattern.Bytes[first]));
+		const auto secondByte = _mm256_set1_epi8(static_cast<char>(pattern.Bytes[second]));
+
+		auto it = begin;
+		for (; static_cast<size_t>(end - it) >= size + Width - 1; it += Width)
+		{
+			const auto equal = _mm256_and_si256(
+				_mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(it + first)), firstByte),
+				_mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(it + second)), secondByte)
+			);
+			for (auto bits = static_cast<uint32_t>(_mm256_movemask_epi8(equal)); bits != 0; bits &= bits - 1)
+			{
+				const auto candidate = it + __builtin_ctz(bits);
+				if (Matches(candidate, pattern))
+				{
+					return candidate;
+				}
+			}
+		}
+		return FindScalar(it, end, pattern, first, second);
+	}
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	const uint8_t* FindNeon(const uint8_t* begin, const uint8_t* end, const BytePattern& pattern, size_t first, size_t second)
+	{
+		constexpr size_t Width = 16;
+
+		const auto size = pattern.Bytes.size();
+		const auto firstByte = vdupq_n_u8(pattern.Bytes[first]);
+		const auto secondByte = vdupq_n_u8(pattern.Bytes[second]);
+
+		auto it = begin;
+		for (; static_cast<size_t>(end - it) >= size + Width - 1; it += Width)
+		{
+			const auto equal = vandq_u8(vceqq_u8(vld1q_u8(it + first), firstByte), vceqq_u8(vld1q_u8(it + second), secondByte));
+
+			//NEON has no movemask, narrowing every 16 bit lane by 4 bits leaves one nibble per byte
+			auto bits = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(equal), 4)), 0);
+			while (bits != 0)
+			{
+				const auto bit = __builtin_ctzll(bits);
+				const auto candidate = it + bit / 4;
+				if (Matches(candidate, pattern))
+				{
+					return candidate;
+				}
+				bits &= ~(0xFull << bit);
+			}
+		}
+		return FindScalar(it, end, pattern, first, second);
+	}
+#endif
+
+	FindFunction SelectImplementation(const char*& name)
+	{
+#if defined(__x86_64__) || defined(__i386__)
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2"))
+		{
+			name = "AVX2";
+			return FindAvx2;
+		}
+#endif
+#if defined(__SSE2__)
+		name = "SSE2";
+		return FindSse2;
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+		name = "NEON";
+		return FindNeon;
+#else
+		name = "scalar";
+		return FindScalar;
+#endif
+	}
+
+	struct Implementation
+	{
+		const char* Name;
+		FindFunction Find;
+
+		Implementation()
+		{
+			Find = SelectImplementation(Name);
+		}
+	};
+
+	const Implementation& GetImplementation()
+	{
+		static const Implementation implementation;
+		return implementation;
+	}
+
+	uint32_t ReadInstruction(const uint8_t* address)
+	{
+		uint32_t instruction;
+		memcpy(&instruction, address, sizeof(instruction));
+		return instruction;
+	}
+
+	int64_t SignExtend(uint64_t value, int bits)
+	{
+		return static_cast<int64_t>(value << (64 - bits)) >> (64 - bits);
+	}
+
+	/// <summary>A signature (global and index) and the module mapping (path, begin and end) it got located in.</summary>
+	using Location = std::tuple<std::string, uint32_t, std::string, uintptr_t, uintptr_t>;
+
+	/// <summary>
+	/// The located signatures, 0 if the signature did not match. The initialization is polled until the engine is ready,
+	/// the bytes of a mapping do not change, so every mapping is scanned once. A module which got mapped again is scanned again.
+	/// </summary>
+	std::mutex locationsMutex;
+	std::map<Location, uintptr_t> locations;
+}
+
+bool PatternScanner::Parse(const std::string& text, BytePattern& pattern)
+{
+	pattern.Bytes.clear();
+	pattern.Mask.clear();
+
+	for (size_t i = 0; i < text.size(); )
+	{
+		if (text[i] == ' ')
+		{
+			++i;
+			continue;
+		}
+
+		auto length = text.find(' ', i);
+		length = (length == std::string::npos ? text.size() : length) - i;
+
+		uint8_t high, highMask, low, lowMask;
+		if (length == 1 && text[i] == '?')
+		{
+			high = low = highMask = lowMask = 0;
+		}
+		else if (length != 2 || !ParseNibble(text[i], high, highMask) || !ParseNibble(text[i + 1], low, lowMask))
+		{
+			return false;
+		}
+
+		pattern.Bytes.push_back(high << 4 | low);
+		pattern.Mask.push_back(highMask << 4 | lowMask);
+
+		i += length;
+	}
+
+	return !pattern.Bytes.empty();
+}
+
+bool PatternScanner::Parse(const char* bytes, const char* mask, BytePattern& pattern)
+{
+	pattern.Bytes.clear();
+	pattern.Mask.clear();
+
+	for (auto i = 0u; mask[i] != '\0'; ++i)
+	{
+		const uint8_t byteMask = mask[i] == 'x' ? 0xFF : 0x00;
+		pattern.Bytes.push_back(static_cast<uint8_t>(bytes[i]) & byteMask);
+		pattern.Mask.push_back(byteMask);
+	}
+
+	return !pattern.Bytes.empty();
+}
+
+const uint8_t* PatternScanner::Find(const uint8_t* begin, const uint8_t* end, const BytePattern& pattern)
+{
+	if (pattern.Bytes.empty() || begin >= end)
+	{
+		return nullptr;
+	}
+
+	size_t first, second;
+	ChooseAnchors(pattern, first, second);
+	if (first == NoAnchor)
+	{
+		return FindMasked(begin, end, pattern);
+	}
+
+	return GetImplementation().Find(begin, end, pattern, first, second);
+}
+
+const char* PatternScanner::GetImplementationName()
+{
+	return GetImplementation().Name;
+}
+
+uintptr_t PatternScanner::Decode(const uint8_t* match, const uint8_t* end, const Signature& signature)
+{
+	const auto instruction = match + signature.Offset;
+	const auto fits = [&](intptr_t offset, size_t size)
+	{
+		return instruction + offset >= match && instruction + offset + size <= end;
+	};
+
+	const auto pc = reinterpret_cast<uintptr_t>(instruction);
+	switch (signature.Type)
+	{
+	case Signature::Kind::Match:
+		return pc;
+	case Signature::Kind::Adrp:
+	{
+		if (!fits(0, 4) || !fits(signature.PairOffset, 4))
+		{
+			return 0;
+		}
+
+		const auto adrp = ReadInstruction(instruction);
+		const auto pair = ReadInstruction(instruction + signature.PairOffset);
+		if ((adrp & 0x9F000000) != 0x90000000 || (pair >> 5 & 0x1F) != (adrp & 0x1F))
+		{
+			return 0;
+		}
+
+		const auto immediate = static_cast<uint64_t>(adrp >> 5 & 0x7FFFF) << 2 | (adrp >> 29 & 0x3);
+		const auto page = (pc & ~static_cast<uintptr_t>(0xFFF)) + SignExtend(immediate, 21) * 4096;
+
+		const auto offset = pair >> 10 & 0xFFF;
+		if ((pair & 0xFF800000) == 0x91000000)
+		{
+			//ADD Xd, Xn, #imm{, LSL #12}
+			return page + (pair & 0x400000 ? offset << 12 : offset);
+		}
+		if ((pair & 0xFFC00000) == 0xF9400000)
+		{
+			//LDR Xt, [Xn, #imm]
+			return page + offset * 8;
+		}
+		return 0;
+	}
+	case Signature::Kind::Branch:
+	{
+		if (!fits(0, 4))
+		{
+			return 0;
+		}
+
+		const auto branch = ReadInstruction(instruction);
+		if ((branch & 0x7C000000) != 0x14000000)
+		{
+			return 0;
+		}
+		return pc + SignExtend(branch & 0x3FFFFFF, 26) * 4;
+	}
+	case Signature::Kind::RipRelative:
+	{
+		if (!fits(signature.DisplacementOffset, 4) || !fits(0, signature.InstructionSize))
+		{
+			return 0;
+		}
+
+		int32_t displacement;
+		memcpy(&displacement, instruction + signature.DisplacementOffset, sizeof(displacement));
+		return pc + signature.InstructionSize + displacement;
+	}
+	default:
+		return 0;
+	}
+}
+
+uintptr_t PatternScanner::Locate(const ModuleMap::Module& module, const Signature& signature)
+{
+	uintptr_t address = 0;
+
+	if (signature.Type == Signature::Kind::Offset)
+	{
+		address = module.Begin + signature.Offset;
+	}
+	else
+	{
+		BytePattern pattern;
+		if (!Parse(signature.Pattern, pattern))
+		{
+			return 0;
+		}
+
+		std::vector<ModuleMap::Segment> segments;
+		std::copy_if(std::begin(module.Segments), std::end(module.Segments), std::back_inserter(segments), [](const ModuleMap::Segment& segment)
+		{
+			return (segment.Protection & PROT_READ) != 0;
+		});
+		std::stable_partition(std::begin(segments), std::end(segments), [](const ModuleMap::Segment& segment)
+		{
+			return (segment.Protection & PROT_EXEC) != 0;
+		});
+
+		for (auto&& segment : segments)
+		{
+			const auto begin = reinterpret_cast<const uint8_t*>(segment.Begin);
+			const auto end = reinterpret_cast<const uint8_t*>(segment.End);
+
+			//a match whose instruction does not decode is a false positive, the search goes on behind it
+			for (auto match = Find(begin, end, pattern); match != nullptr && address == 0; match = Find(match + 1, end, pattern))
+			{
+				address = Decode(match, end, signature);
+			}
+			if (address != 0)
+			{
+				break;
+			}
+		}
+	}
+
+	return address;
+}
+
+uintptr_t PatternScanner::Dereference(uintptr_t address, const Signature& signature)
+{
+	if (address != 0 && signature.Dereference)
+	{
+		if (!Tools::IsPtrValid(reinterpret_cast<void*>(address), sizeof(uintptr_t)))
+		{
+			return 0;
+		}
+		address = *reinterpret_cast<const uintptr_t*>(address);
+	}
+
+	return address;
+}
+
+uintptr_t PatternScanner::Resolve(const ModuleMap::Module& module, const Signature& signature)
+{
+	return Dereference(Locate(module, signature), signature);
+}
+
+uintptr_t PatternScanner::Resolve(const std::string& moduleName, const std::vector<Signature>& signatures, const std::string& name)
+{
+	ModuleMap::Module module;
+	if (!ModuleMap::GetModule(moduleName, module))
+	{
+		return 0;
+	}
+
+	for (auto i = 0u; i < signatures.size(); ++i)
+	{
+		if (signatures[i].Name != name)
+		{
+			continue;
+		}
+
+		//the pointer a signature dereferences may still be null, only the location is reused
+		const auto location = std::make_tuple(name, i, module.Path, module.Begin, module.End);
+		uintptr_t located;
+		{
+			std::lock_guard<std::mutex> lock(locationsMutex);
+			auto it = locations.find(location);
+			if (it == std::end(locations))
+			{
+				it = locations.emplace(location, Locate(module, signatures[i])).first;
+				if (it->second == 0)
+				{
+					LOGW("Signature %u of %s did not match in %s, it is not scanned again until the module gets mapped again", i, name.c_str(), moduleName.c_str());
+				}
+			}
+			located = it->second;
+		}
+
+		const auto address = Dereference(located, signatures[i]);
+		if (address != 0)
+		{
+			LOGI("Resolved %s with signature %u at %s+0x%llx", name.c_str(), i, moduleName.c_str(), static_cast<unsigned long long>(address - module.Begin));
+			return address;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ModuleMap.hpp"
+
+/// <summary>A byte pattern with a mask, a byte matches if (byte &amp; Mask) == Bytes.</summary>
+struct BytePattern
+{
+	std::vector<uint8_t> Bytes;
+	std::vector<uint8_t> Mask;
+};
+
+/// <summary>
+/// Describes how to find a global in a module, see <see cref="IGenerator::GetSignatures" />.
+/// </summary>
+struct Signature
+{
+	enum class Kind
+	{
+		/// <summary>The address is the module base plus Offset, a fixed offset of one build.</summary>
+		Offset,
+		/// <summary>The address is the match plus Offset.</summary>
+		Match,
+		/// <summary>An arm64 ADRP at the match plus Offset followed by an ADD or LDR (64 bit, unsigned offset) at PairOffset.</summary>
+		Adrp,
+		/// <summary>An arm64 B or BL at the match plus Offset, the address is the branch target.</summary>
+		Branch,
+		/// <summary>An x86 instruction at the match plus Offset with a disp32 at DisplacementOffset relative to its end.</summary>
+		RipRelative
+	};
+
+	/// <summary>The name of the global, the stores look up "GetNames" (the names store accessor) and "GUObjectArray".</summary>
+	std::string Name;
+	Kind Type;
+	/// <summary>Hex bytes separated by spaces, "??" or "?" matches any byte and "?8" or "8?" one nibble, e.g. "08 ?? ?? ?0 08 ?? ?? 91".</summary>
+	std::string Pattern;
+	intptr_t Offset;
+
+	int32_t PairOffset = 4;
+	int32_t DisplacementOffset = 3;
+	int32_t InstructionSize = 7;
+
+	/// <summary>The resolved address holds a pointer to the global, e.g. a slot of the global offset table.</summary>
+	bool Dereference = false;
+};
+
+/// <summary>
+/// Finds masked byte patterns in memory. The search compares two anchor bytes of the pattern against 16 (NEON, SSE2) or
+/// 32 (AVX2) positions at once and only verifies the whole pattern at the candidates, which scans a module of 150 MB in a
+/// few tens of milliseconds. AVX2 is selected at runtime, without SIMD support memchr finds the candidates.
+/// </summary>
+class PatternScanner
+{
+public:
+	/// <summary>Parses a pattern like "48 8B 05 ?? ?? ?? ??".</summary>
+	/// <returns>true if it succeeds, false if the text contains an invalid token or no byte.</returns>
+	static bool Parse(const std::string& text, BytePattern& pattern);
+
+	/// <summary>Builds a pattern from raw bytes and a mask of 'x' (compare) and '?' (any byte), e.g. "\x48\x8B" and "xx".</summary>
+	/// <returns>true if it succeeds, false if the mask is empty.</returns>
+	static bool Parse(const char* bytes, const char* mask, BytePattern& pattern);
+
+	/// <summary>Finds the first match of a pattern in [begin, end).</summary>
+	/// <returns>The match, nullptr if there is none.</returns>
+	static const uint8_t* Find(const uint8_t* begin, const uint8_t* end, const BytePattern& pattern);
+
+	/// <summary>Gets the name of the implementation <see cref="Find" /> uses, e.g. "AVX2".</summary>
+	static const char* GetImplementationName();
+
+	/// <summary>Decodes the instruction of a signature at a match, the instruction must lie in [match, end).</summary>
+	/// <returns>The address, 0 if the bytes are not the instruction the signature expects.</returns>
+	static uintptr_t Decode(const uint8_t* match, const uint8_t* end, const Signature& signature);
+
+	/// <summary>
+	/// Locates a signature in the readable segments of a module, the executable segments are scanned first.
+	/// </summary>
+	/// <returns>The decoded address before <see cref="Signature::Dereference" />, 0 if the pattern is not found or can not be decoded.</returns>
+	static uintptr_t Locate(const ModuleMap::Module& module, const Signature& signature);
+
+	/// <summary>Reads the pointer at a located address if the signature dereferences it.</summary>
+	/// <returns>The address, 0 if the located address is 0 or can not be read.</returns>
+	static uintptr_t Dereference(uintptr_t address, const Signature& signature);
+
+	/// <summary>Locates and dereferences a signature, see <see cref="Locate" /> and <see cref="Dereference" />.</summary>
+	/// <returns>The address, 0 if the pattern is not found or can not be decoded.</returns>
+	static uintptr_t Resolve(const ModuleMap::Module& module, const Signature& signature);
+
+	/// <summary>
+	/// Resolves a global with the first of its signatures which succeeds. The location of every signature is cached per
+	/// module mapping, a module is scanned for a signature once until it gets mapped at another address.
+	/// </summary>
+	/// <param name="moduleName">The module, e.g. libUE4.so.</param>
+	/// <param name="signatures">The signatures of all globals.</param>
+	/// <param name="name">The name of the global.</param>
+	/// <returns>The address, 0 if the module is not loaded or no signature of the global succeeds.</returns>
+	static uintptr_t Resolve(const std::string& moduleName, const std::vector<Signature>& signatures, const std::string& name);
+};
@@ -55,6 +55,11 @@ void PrintSectionHeader(std::ostream& os, const char* name)
 }
 
 std::string GenerateFileName(FileContentType type, const Package& package)
+{
+	return GenerateFileName(type, package.GetName());
+}
+
+std::string GenerateFileName(FileContentType type, const std::string& packageName)
 {
 	extern IGenerator* generator;
 
@@ -77,5 +82,5 @@ std::string GenerateFileName(FileContentType type, const Package& package)
 		assert(false);
 	}
 
-	return tfm::format(name, generator->GetGameNameShort(), package.GetName());
+	return tfm::format(name, generator->GetGameNameShort(), packageName);
 }
@@ -27,3 +27,13 @@ enum class FileContentType
 /// The generated file name.
 /// </returns>
 std::string GenerateFileName(const FileContentType type, const class Package& package);
+
+/// <summary>
+/// Generates a file name composed by the game name and the package name.
+/// </summary>
+/// <param name="type">The type of the file.</param>
+/// <param name="packageName">The name of the package.</param>
+/// <returns>
+/// The generated file name.
+/// </returns>
+std::string GenerateFileName(const FileContentType type, const std::string& packageName);
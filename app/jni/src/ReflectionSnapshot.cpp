@@ -0,0 +1,545 @@
+#include "ReflectionSnapshot.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <string>
+#include <vector>
+
+#include "ObjectsStore.hpp"
+#include "NamesStore.hpp"
+#include "EngineClasses.hpp"
+#include "Tools.h"
+
+namespace
+{
+	struct SnapshotData
+	{
+		bool Initialized = false;
+
+		std::vector<UObject*> Objects;
+		std::vector<uint8_t> Shapes;
+
+		std::vector<int32_t> Classes;
+		std::vector<int32_t> Outers;
+		std::vector<int32_t> NameIndices;
+		std::vector<int32_t> NameNumbers;
+		std::vector<std::string_view> Names;
+		std::vector<char> NumberedNames;
+		std::vector<int32_t> ObjectFlags;
+
+		std::vector<int32_t> Nexts;
+
+		std::vector<int32_t> Supers;
+		std::vector<int32_t> Children;
+		std::vector<int32_t> PropertySizes;
+
+		std::vector<int32_t> Offsets;
+		std::vector<int32_t> ElementSizes;
+		std::vector<int32_t> ArrayDims;
+		std::vector<uint64_t> PropertyFlags;
+
+		std::vector<uint32_t> FunctionFlags;
+
+		std::vector<int32_t> Packages;
+		std::vector<std::string_view> FullNames;
+		std::vector<std::string_view> Paths;
+		std::vector<char> PathData;
+
+		/// <summary>
+		/// The captured rows ordered by the address of their object. While the snapshot gets built it holds every row
+		/// with an object, so referenced pointers are resolved without reading them.
+		/// </summary>
+		std::vector<int32_t> RowsByAddress;
+	};
+
+	SnapshotData data;
+
+	int32_t ResolveRow(const UObject* object)
+	{
+		if (object == nullptr)
+		{
+			return ReflectionSnapshot::NullRow;
+		}
+
+		//the pointer may be garbage, it is only compared to the objects of the array
+		const auto it = std::lower_bound(std::begin(data.RowsByAddress), std::end(data.RowsByAddress), object, [](int32_t row, const UObject* value)
+		{
+			return data.Objects[row] < value;
+		});
+		if (it == std::end(data.RowsByAddress) || data.Objects[*it] != object)
+		{
+			return ReflectionSnapshot::ForeignRow;
+		}
+		return *it;
+	}
+
+	bool IsNamed(int32_t row, const char* name)
+	{
+		if (data.NameNumbers[row] != 0)
+		{
+			return false;
+		}
+
+		return NamesStore().GetShortViewById(data.NameIndices[row]) == name;
+	}
+
+	/// <summary>Rows of the CoreUObject classes which define the layout of an object.</summary>
+	struct CoreClassRows
+	{
+		int32_t Field = ReflectionSnapshot::NullRow;
+		int32_t Struct = ReflectionSnapshot::NullRow;
+		int32_t Function = ReflectionSnapshot::NullRow;
+		int32_t Property = ReflectionSnapshot::NullRow;
+	};
+
+	bool FindCoreClassRows(CoreClassRows& core)
+	{
+		const auto count = static_cast<int32_t>(data.Objects.size());
+
+		auto coreObjectPackage = ReflectionSnapshot::NullRow;
+		for (auto row = 0; row < count; ++row)
+		{
+			if (data.Shapes[row] != static_cast<uint8_t>(ReflectionSnapshot::Shape::None)
+				&& data.Outers[row] == ReflectionSnapshot::NullRow
+				&& IsNamed(row, "CoreUObject"))
+			{
+				coreObjectPackage = row;
+				break;
+			}
+		}
+		if (coreObjectPackage == ReflectionSnapshot::NullRow)
+		{
+			return false;
+		}
+
+		for (auto row = 0; row < count; ++row)
+		{
+			if (data.Shapes[row] == static_cast<uint8_t>(ReflectionSnapshot::Shape::None)
+				|| data.Outers[row] != coreObjectPackage
+				|| data.Classes[row] < 0
+				|| !IsNamed(data.Classes[row], "Class"))
+			{
+				continue;
+			}
+
+			if (IsNamed(row, "Field")) { core.Field = row; }
+			else if (IsNamed(row, "Struct")) { core.Struct = row; }
+			else if (IsNamed(row, "Function")) { core.Function = row; }
+			else if (IsNamed(row, "Property")) { core.Property = row; }
+		}
+
+		return core.Field != ReflectionSnapshot::NullRow
+			&& core.Struct != ReflectionSnapshot::NullRow
+			&& core.Function != ReflectionSnapshot::NullRow
+			&& core.Property != ReflectionSnapshot::NullRow;
+	}
+
+	/// <summary>The size of the engine class the fields of a shape are copied from.</summary>
+	size_t GetShapeSize(ReflectionSnapshot::Shape shape)
+	{
+		using Shape = ReflectionSnapshot::Shape;
+
+		switch (shape)
+		{
+		case Shape::Field: return sizeof(UField);
+		case Shape::Struct: return sizeof(UStruct);
+		case Shape::Function: return sizeof(UFunction);
+		case Shape::Property: return sizeof(UProperty);
+		default: return sizeof(UObject);
+		}
+	}
+
+	/// <summary>Determines the shape of the instances of a class by walking its super chain once.</summary>
+	ReflectionSnapshot::Shape GetInstanceShape(int32_t classRow, const CoreClassRows& core, std::vector<uint8_t>& cache)
+	{
+		using Shape = ReflectionSnapshot::Shape;
+
+		auto& cached = cache[classRow];
+		if (cached != static_cast<uint8_t>(Shape::None))
+		{
+			return static_cast<Shape>(cached);
+		}
+
+		auto shape = Shape::Object;
+		for (auto superRow = classRow; superRow >= 0; )
+		{
+			if (superRow == core.Function) { shape = Shape::Function; break; }
+			if (superRow == core.Struct) { shape = Shape::Struct; break; }
+			if (superRow == core.Property) { shape = Shape::Property; break; }
+			if (superRow == core.Field) { shape = Shape::Field; break; }
+
+			//the chain ends at a super which is not an object of the array or can not be read
+			const auto super = data.Objects[superRow];
+			if (!Tools::IsPtrValid(super, sizeof(UStruct), false))
+			{
+				break;
+			}
+			superRow = ResolveRow(static_cast<UStruct*>(super)->SuperStruct);
+		}
+
+		cached = static_cast<uint8_t>(shape);
+		return shape;
+	}
+
+	/// <summary>
+	/// Computes the package, the path and the full name of every row in one top-down pass.
+	/// The path of a row is the path of its outer plus its own name, so every outer chain is walked only once.
+	/// Rows whose outer chain leaves the snapshot get no path and no package.
+	/// </summary>
+	void BuildPaths()
+	{
+		const auto count = static_cast<int32_t>(data.Objects.size());
+
+		const auto isCaptured = [](int32_t row) { return data.Shapes[row] != static_cast<uint8_t>(ReflectionSnapshot::Shape::None); };
+
+		//order the rows so that every outer comes before the objects it contains
+		std::vector<int32_t> order;
+		order.reserve(count);
+		{
+			std::vector<uint8_t> visited(count, 0);
+			std::vector<int32_t> chain;
+			for (auto i = 0; i < count; ++i)
+			{
+				for (auto row = i; row != ReflectionSnapshot::NullRow && isCaptured(row) && !visited[row]; row = data.Outers[row])
+				{
+					visited[row] = 1;
+					chain.push_back(row);
+				}
+				order.insert(std::end(order), chain.rbegin(), chain.rend());
+				chain.clear();
+			}
+		}
+
+		//compute the lengths, an outer is always handled before the objects it contains
+		constexpr uint32_t NoPath = UINT32_MAX;
+		std::vector<uint32_t> pathLengths(count, NoPath);
+		std::vector<uint32_t> classNameLengths(count, 0);
+		data.Packages.assign(count, ReflectionSnapshot::ForeignRow);
+
+		size_t size = 0;
+		for (auto row : order)
+		{
+			const auto outer = data.Outers[row];
+			auto pathLength = static_cast<uint32_t>(data.Names[row].size());
+			if (outer != ReflectionSnapshot::NullRow)
+			{
+				if (pathLengths[outer] == NoPath)
+				{
+					continue;
+				}
+				pathLength += pathLengths[outer] + 1;
+				data.Packages[row] = data.Packages[outer] == ReflectionSnapshot::NullRow ? outer : data.Packages[outer];
+			}
+			else
+			{
+				data.Packages[row] = ReflectionSnapshot::NullRow;
+			}
+
+			const auto classRow = data.Classes[row];
+			if (classRow != ReflectionSnapshot::NullRow)
+			{
+				classNameLengths[row] = static_cast<uint32_t>(data.Names[classRow].size());
+			}
+
+			pathLengths[row] = pathLength;
+			size += classNameLengths[row] + 1 + pathLength;
+		}
+
+		//write "<class name> <outer path>.<name>" for every row
+		data.PathData.resize(size);
+		data.FullNames.assign(count, std::string_view());
+		data.Paths.assign(count, std::string_view());
+
+		auto buffer = data.PathData.data();
+		for (auto row : order)
+		{
+			if (pathLengths[row] == NoPath)
+			{
+				continue;
+			}
+
+			const auto start = buffer;
+
+			const auto classRow = data.Classes[row];
+			if (classRow != ReflectionSnapshot::NullRow)
+			{
+				buffer = std::copy(std::begin(data.Names[classRow]), std::end(data.Names[classRow]), buffer);
+			}
+			*buffer++ = ' ';
+
+			const auto path = buffer;
+			const auto outer = data.Outers[row];
+			if (outer != ReflectionSnapshot::NullRow)
+			{
+				buffer = std::copy(std::begin(data.Paths[outer]), std::end(data.Paths[outer]), buffer);
+				*buffer++ = '.';
+			}
+			buffer = std::copy(std::begin(data.Names[row]), std::end(data.Names[row]), buffer);
+
+			data.FullNames[row] = std::string_view(start, buffer - start);
+			data.Paths[row] = std::string_view(path, buffer - path);
+		}
+	}
+}
+
+constexpr int32_t ReflectionSnapshot::NullRow;
+constexpr int32_t ReflectionSnapshot::ForeignRow;
+
+UObject* const* ReflectionSnapshot::objects = nullptr;
+const uint8_t* ReflectionSnapshot::shapes = nullptr;
+const int32_t* ReflectionSnapshot::classes = nullptr;
+const int32_t* ReflectionSnapshot::outers = nullptr;
+const int32_t* ReflectionSnapshot::nameIndices = nullptr;
+const int32_t* ReflectionSnapshot::nameNumbers = nullptr;
+const std::string_view* ReflectionSnapshot::names = nullptr;
+const int32_t* ReflectionSnapshot::objectFlags = nullptr;
+const int32_t* ReflectionSnapshot::nexts = nullptr;
+const int32_t* ReflectionSnapshot::supers = nullptr;
+const int32_t* ReflectionSnapshot::children = nullptr;
+const int32_t* ReflectionSnapshot::propertySizes = nullptr;
+const int32_t* ReflectionSnapshot::offsets = nullptr;
+const int32_t* ReflectionSnapshot::elementSizes = nullptr;
+const int32_t* ReflectionSnapshot::arrayDims = nullptr;
+const uint64_t* ReflectionSnapshot::propertyFlags = nullptr;
+const uint32_t* ReflectionSnapshot::functionFlags = nullptr;
+const int32_t* ReflectionSnapshot::packages = nullptr;
+const std::string_view* ReflectionSnapshot::fullNames = nullptr;
+const std::string_view* ReflectionSnapshot::paths = nullptr;
+
+bool ReflectionSnapshot::Initialize()
+{
+	if (data.Initialized)
+	{
+		return true;
+	}
+
+	const ObjectsStore store;
+	const auto count = store.GetObjectsNum();
+
+	data.Objects.resize(count);
+	data.Shapes.assign(count, static_cast<uint8_t>(Shape::None));
+	data.Classes.assign(count, NullRow);
+	data.Outers.assign(count, NullRow);
+	data.NameIndices.assign(count, 0);
+	data.NameNumbers.assign(count, 0);
+	data.ObjectFlags.assign(count, 0);
+	data.Nexts.assign(count, NullRow);
+	data.Supers.assign(count, NullRow);
+	data.Children.assign(count, NullRow);
+	data.PropertySizes.assign(count, 0);
+	data.Offsets.assign(count, 0);
+	data.ElementSizes.assign(count, 0);
+	data.ArrayDims.assign(count, 0);
+	data.PropertyFlags.assign(count, 0);
+	data.FunctionFlags.assign(count, 0);
+
+	data.RowsByAddress.clear();
+	for (auto i = 0u; i < count; ++i)
+	{
+		data.Objects[i] = static_cast<UObject*>(store.GetById(i).GetAddress());
+		if (data.Objects[i] != nullptr)
+		{
+			data.RowsByAddress.push_back(i);
+		}
+	}
+	std::sort(std::begin(data.RowsByAddress), std::end(data.RowsByAddress), [](int32_t lhs, int32_t rhs) { return data.Objects[lhs] < data.Objects[rhs]; });
+
+	//copy the object headers
+	for (auto i = 0u; i < count; ++i)
+	{
+		const auto object = data.Objects[i];
+		if (object == nullptr || !Tools::IsPtrValid(object, sizeof(UObject)) || object->InternalIndex != static_cast<int32_t>(i))
+		{
+			continue;
+		}
+
+		const auto classRow = ResolveRow(object->ClassPrivate);
+		const auto outerRow = ResolveRow(object->OuterPrivate);
+		if (classRow == ReflectionSnapshot::ForeignRow || outerRow == ReflectionSnapshot::ForeignRow)
+		{
+			continue;
+		}
+
+		data.Shapes[i] = static_cast<uint8_t>(Shape::Object);
+		data.Classes[i] = classRow;
+		data.Outers[i] = outerRow;
+		data.NameIndices[i] = object->NamePrivate.ComparisonIndex;
+		data.NameNumbers[i] = object->NamePrivate.Number;
+		data.ObjectFlags[i] = object->ObjectFlags;
+	}
+
+	//names with a number need their own storage, all other names point into the name table
+	const NamesStore namesStore;
+	size_t numberedNamesSize = 0;
+	for (auto i = 0u; i < count; ++i)
+	{
+		if (data.Shapes[i] != static_cast<uint8_t>(Shape::None) && data.NameNumbers[i] > 0)
+		{
+			numberedNamesSize += namesStore.GetShortViewById(data.NameIndices[i]).size() + 1 + std::to_string(data.NameNumbers[i]).size();
+		}
+	}
+	data.NumberedNames.reserve(numberedNamesSize);
+	data.Names.resize(count);
+	for (auto i = 0u; i < count; ++i)
+	{
+		if (data.Shapes[i] == static_cast<uint8_t>(Shape::None))
+		{
+			continue;
+		}
+
+		const auto name = namesStore.GetShortViewById(data.NameIndices[i]);
+		if (data.NameNumbers[i] > 0)
+		{
+			const auto number = std::to_string(data.NameNumbers[i]);
+			const auto start = data.NumberedNames.size();
+			data.NumberedNames.insert(std::end(data.NumberedNames), std::begin(name), std::end(name));
+			data.NumberedNames.push_back('_');
+			data.NumberedNames.insert(std::end(data.NumberedNames), std::begin(number), std::end(number));
+			data.Names[i] = std::string_view(data.NumberedNames.data() + start, data.NumberedNames.size() - start);
+		}
+		else
+		{
+			data.Names[i] = name;
+		}
+	}
+
+	CoreClassRows core;
+	if (!FindCoreClassRows(core))
+	{
+		return false;
+	}
+
+	//copy the type specific fields
+	std::vector<uint8_t> instanceShapes(count, static_cast<uint8_t>(Shape::None));
+	for (auto i = 0u; i < count; ++i)
+	{
+		if (data.Shapes[i] == static_cast<uint8_t>(Shape::None) || data.Classes[i] == NullRow)
+		{
+			continue;
+		}
+
+		const auto object = data.Objects[i];
+		const auto shape = GetInstanceShape(data.Classes[i], core, instanceShapes);
+		if (shape == Shape::Object)
+		{
+			continue;
+		}
+		if (!Tools::IsPtrValid(object, GetShapeSize(shape)))
+		{
+			data.Shapes[i] = static_cast<uint8_t>(Shape::None);
+			continue;
+		}
+
+		const auto nextRow = ResolveRow(static_cast<UField*>(object)->Next);
+		if (nextRow == ReflectionSnapshot::ForeignRow)
+		{
+			data.Shapes[i] = static_cast<uint8_t>(Shape::None);
+			continue;
+		}
+		data.Nexts[i] = nextRow;
+
+		if (shape == Shape::Struct || shape == Shape::Function)
+		{
+			const auto structObj = static_cast<UStruct*>(object);
+
+			const auto superRow = ResolveRow(structObj->SuperStruct);
+			const auto childrenRow = ResolveRow(structObj->Children);
+			if (superRow == ReflectionSnapshot::ForeignRow || childrenRow == ReflectionSnapshot::ForeignRow)
+			{
+				data.Shapes[i] = static_cast<uint8_t>(Shape::None);
+				continue;
+			}
+			data.Supers[i] = superRow;
+			data.Children[i] = childrenRow;
+			data.PropertySizes[i] = structObj->PropertySize;
+
+			if (shape == Shape::Function)
+			{
+				data.FunctionFlags[i] = static_cast<UFunction*>(object)->FunctionFlags;
+			}
+		}
+		else if (shape == Shape::Property)
+		{
+			const auto property = static_cast<UProperty*>(object);
+
+			data.Offsets[i] = property->Offset;
+			data.ElementSizes[i] = property->ElementSize;
+			data.ArrayDims[i] = property->ArrayDim;
+			data.PropertyFlags[i] = static_cast<uint64_t>(property->PropertyFlags.A);
+		}
+
+		data.Shapes[i] = static_cast<uint8_t>(shape);
+	}
+
+	BuildPaths();
+
+	//only the captured rows stay, in address order
+	data.RowsByAddress.erase(std::remove_if(std::begin(data.RowsByAddress), std::end(data.RowsByAddress), [](int32_t row)
+	{
+		return data.Shapes[row] == static_cast<uint8_t>(Shape::None);
+	}), std::end(data.RowsByAddress));
+
+	objects = data.Objects.data();
+	shapes = data.Shapes.data();
+	classes = data.Classes.data();
+	outers = data.Outers.data();
+	nameIndices = data.NameIndices.data();
+	nameNumbers = data.NameNumbers.data();
+	names = data.Names.data();
+	objectFlags = data.ObjectFlags.data();
+	nexts = data.Nexts.data();
+	supers = data.Supers.data();
+	children = data.Children.data();
+	propertySizes = data.PropertySizes.data();
+	offsets = data.Offsets.data();
+	elementSizes = data.ElementSizes.data();
+	arrayDims = data.ArrayDims.data();
+	propertyFlags = data.PropertyFlags.data();
+	functionFlags = data.FunctionFlags.data();
+	packages = data.Packages.data();
+	fullNames = data.FullNames.data();
+	paths = data.Paths.data();
+
+	data.Initialized = true;
+
+	return true;
+}
+
+bool ReflectionSnapshot::IsInitialized()
+{
+	return data.Initialized;
+}
+
+size_t ReflectionSnapshot::GetRowsNum() const
+{
+	return data.Objects.size();
+}
+
+int32_t ReflectionSnapshot::GetRow(const UObject* object) const
+{
+	if (!data.Initialized || object == nullptr)
+	{
+		return NullRow;
+	}
+
+	const auto it = std::lower_bound(std::begin(data.RowsByAddress), std::end(data.RowsByAddress), object, [](int32_t row, const UObject* value)
+	{
+		return data.Objects[row] < value;
+	});
+	if (it == std::end(data.RowsByAddress) || data.Objects[*it] != object)
+	{
+		return NullRow;
+	}
+	return *it;
+}
+
+int32_t ReflectionSnapshot::GetRow(size_t index, const UObject* object) const
+{
+	if (!data.Initialized || object == nullptr || index >= data.Objects.size() || data.Objects[index] != object
+		|| data.Shapes[index] == static_cast<uint8_t>(Shape::None))
+	{
+		return NullRow;
+	}
+	return static_cast<int32_t>(index);
+}
+
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include "UE4/GenericTypes.hpp"
+
+/// <summary>
+/// A flat struct-of-arrays copy of the reflection data of every object in the global objects store.
+/// Every field the generator needs (class, outer, name, super, children, next, offsets, sizes and flags)
+/// is copied once into dense arrays which are addressed by the object index, so walking the object graph
+/// no longer has to follow pointers to random places in the heap.
+/// References between objects are stored as rows (object indices) of the snapshot.
+/// </summary>
+class ReflectionSnapshot
+{
+public:
+	/// <summary>The row of a null reference.</summary>
+	static constexpr int32_t NullRow = -1;
+
+	/// <summary>The row of a reference to an object which is not captured by the snapshot.</summary>
+	static constexpr int32_t ForeignRow = -2;
+
+	/// <summary>The kind of data which was captured for a row.</summary>
+	enum class Shape : uint8_t
+	{
+		/// <summary>The row was not captured, all accessors must read the live object.</summary>
+		None,
+		Object,
+		Field,
+		Struct,
+		Function,
+		Property
+	};
+
+	/// <summary>
+	/// Builds the snapshot from the global objects and names store.
+	/// Must be called after <see cref="NamesStore::Initialize()" /> and <see cref="ObjectsStore::Initialize()" />.
+	/// </summary>
+	/// <returns>true if it succeeds, false if it fails.</returns>
+	static bool Initialize();
+
+	/// <summary>Checks if the snapshot got built.</summary>
+	/// <returns>true if the snapshot is available.</returns>
+	static bool IsInitialized();
+
+	/// <summary>Gets the number of rows.</summary>
+	/// <returns>The number of rows.</returns>
+	size_t GetRowsNum() const;
+
+	/// <summary>
+	/// Gets the row of the object by a binary search over the addresses of the captured objects, the object is not read.
+	/// Objects which were created after the snapshot got built have no row.
+	/// </summary>
+	/// <param name="object">The object.</param>
+	/// <returns>The row of the object or <see cref="NullRow" /> if the object is not captured.</returns>
+	int32_t GetRow(const UObject* object) const;
+
+	/// <summary>Gets the row of the object in a slot of the objects store, the object is not read.</summary>
+	/// <param name="index">The index of the slot.</param>
+	/// <param name="object">The object in the slot.</param>
+	/// <returns>The row of the object or <see cref="NullRow" /> if the object is not captured.</returns>
+	int32_t GetRow(size_t index, const UObject* object) const;
+
+	/// <summary>Gets the object of the row.</summary>
+	/// <param name="row">The row.</param>
+	/// <returns>The object or nullptr if the row is <see cref="NullRow" />.</returns>
+	UObject* GetObject(int32_t row) const
+	{
+		return row == NullRow ? nullptr : objects[row];
+	}
+
+	Shape GetShape(int32_t row) const { return static_cast<Shape>(shapes[row]); }
+
+	int32_t GetClass(int32_t row) const { return classes[row]; }
+
+	int32_t GetOuter(int32_t row) const { return outers[row]; }
+
+	int32_t GetNameIndex(int32_t row) const { return nameIndices[row]; }
+
+	int32_t GetNameNumber(int32_t row) const { return nameNumbers[row]; }
+
+	/// <summary>Gets the name of the row without path and with the number suffix applied.</summary>
+	/// <param name="row">The row.</param>
+	/// <returns>The name.</returns>
+	std::string_view GetName(int32_t row) const { return names[row]; }
+
+	int32_t GetObjectFlags(int32_t row) const { return objectFlags[row]; }
+
+	int32_t GetNext(int32_t row) const { return nexts[row]; }
+
+	int32_t GetSuper(int32_t row) const { return supers[row]; }
+
+	int32_t GetChildren(int32_t row) const { return children[row]; }
+
+	int32_t GetPropertySize(int32_t row) const { return propertySizes[row]; }
+
+	int32_t GetOffset(int32_t row) const { return offsets[row]; }
+
+	int32_t GetElementSize(int32_t row) const { return elementSizes[row]; }
+
+	int32_t GetArrayDim(int32_t row) const { return arrayDims[row]; }
+
+	uint64_t GetPropertyFlags(int32_t row) const { return propertyFlags[row]; }
+
+	uint32_t GetFunctionFlags(int32_t row) const { return functionFlags[row]; }
+
+	/// <summary>Gets the first row of the outer chain (the package) of the row.</summary>
+	/// <param name="row">The row.</param>
+	/// <returns>
+	/// The row of the package, <see cref="NullRow" /> if the row is a package
+	/// or <see cref="ForeignRow" /> if the outer chain leaves the snapshot.
+	/// </returns>
+	int32_t GetPackage(int32_t row) const { return packages[row]; }
+
+	/// <summary>
+	/// Gets the full name ("Class CoreUObject.Object") of the row.
+	/// The full names of all rows are computed once, parent first, while the snapshot is built.
+	/// </summary>
+	/// <param name="row">The row.</param>
+	/// <returns>The full name or an empty view if the outer chain leaves the snapshot.</returns>
+	std::string_view GetFullName(int32_t row) const { return fullNames[row]; }
+
+	/// <summary>Gets the path ("CoreUObject.Object") of the row.</summary>
+	/// <param name="row">The row.</param>
+	/// <returns>The path or an empty view if the outer chain leaves the snapshot.</returns>
+	std::string_view GetPath(int32_t row) const { return paths[row]; }
+
+private:
+	static UObject* const* objects;
+	static const uint8_t* shapes;
+	static const int32_t* classes;
+	static const int32_t* outers;
+	static const int32_t* nameIndices;
+	static const int32_t* nameNumbers;
+	static const std::string_view* names;
+	static const int32_t* objectFlags;
+	static const int32_t* nexts;
+	static const int32_t* supers;
+	static const int32_t* children;
+	static const int32_t* propertySizes;
+	static const int32_t* offsets;
+	static const int32_t* elementSizes;
+	static const int32_t* arrayDims;
+	static const uint64_t* propertyFlags;
+	static const uint32_t* functionFlags;
+	static const int32_t* packages;
+	static const std::string_view* fullNames;
+	static const std::string_view* paths;
+};
@@ -0,0 +1,247 @@
+#include "SnapshotFile.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "Logger.hpp"
+#include "NamesStore.hpp"
+#include "ObjectsStore.hpp"
+#include "EngineClasses.hpp"
+#include "Tools.h"
+
+#ifndef MAP_FIXED_NOREPLACE
+#define MAP_FIXED_NOREPLACE 0x100000
+#endif
+
+constexpr const char* SnapshotFile::FileName;
+constexpr uint32_t SnapshotFile::Magic;
+constexpr uint32_t SnapshotFile::Version;
+constexpr uint32_t SnapshotFile::PageSize;
+
+namespace
+{
+	uint64_t AlignUp(uint64_t value, uint64_t alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	bool WriteAll(int fd, const void* data, size_t size, uint64_t offset)
+	{
+		auto bytes = static_cast<const char*>(data);
+		while (size > 0)
+		{
+			const auto written = pwrite(fd, bytes, size, offset);
+			if (written < 0)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+				return false;
+			}
+			bytes += written;
+			size -= written;
+			offset += written;
+		}
+		return true;
+	}
+
+	/// <summary>Collects the memory of the global stores, of every object and of the names of every enum.</summary>
+	std::vector<std::pair<const void*, size_t>> CollectRanges()
+	{
+		std::vector<std::pair<const void*, size_t>> ranges;
+
+		NamesStore::GetMemoryRanges(ranges);
+		ObjectsStore::GetMemoryRanges(ranges);
+
+		const auto enumClass = UEEnum::StaticClass();
+
+		for (auto obj : ObjectsStore())
+		{
+			//the class knows the size of its instances
+			const auto cls = obj.GetClass();
+			const auto size = cls.IsValid() ? cls.GetPropertySize() : 0;
+			ranges.emplace_back(obj.GetAddress(), std::max(size, sizeof(UObject)));
+
+			if (obj.IsA(enumClass))
+			{
+				const auto& names = static_cast<const UEnum*>(obj.GetAddress())->Names;
+				if (names.Num() > 0)
+				{
+					ranges.emplace_back(&names[0], names.Num() * sizeof(names[0]));
+				}
+			}
+		}
+
+		return ranges;
+	}
+
+	/// <summary>Merges the pages of the readable ranges into runs of consecutive pages.</summary>
+	std::vector<SnapshotFile::Run> BuildRuns(const std::vector<std::pair<const void*, size_t>>& ranges)
+	{
+		std::vector<uint64_t> pages;
+		size_t unreadable = 0;
+		for (auto&& range : ranges)
+		{
+			if (range.first == nullptr || range.second == 0)
+			{
+				continue;
+			}
+
+			//an unreadable page would make pwrite fail for the whole run
+			if (!Tools::IsPtrValid(range.first, range.second))
+			{
+				++unreadable;
+				continue;
+			}
+
+			const auto begin = reinterpret_cast<uintptr_t>(range.first) / SnapshotFile::PageSize;
+			const auto end = (reinterpret_cast<uintptr_t>(range.first) + range.second - 1) / SnapshotFile::PageSize;
+			for (auto page = begin; page <= end; ++page)
+			{
+				pages.push_back(page);
+			}
+		}
+		std::sort(std::begin(pages), std::end(pages));
+		pages.erase(std::unique(std::begin(pages), std::end(pages)), std::end(pages));
+
+		std::vector<SnapshotFile::Run> runs;
+		for (auto&& page : pages)
+		{
+			if (!runs.empty() && runs.back().Address + runs.back().Size == page * SnapshotFile::PageSize)
+			{
+				runs.back().Size += SnapshotFile::PageSize;
+			}
+			else
+			{
+				runs.push_back({ page * SnapshotFile::PageSize, SnapshotFile::PageSize, 0 });
+			}
+		}
+
+		if (unreadable > 0)
+		{
+			Logger::Log("Skipped %d unreadable ranges", unreadable);
+		}
+
+		return runs;
+	}
+}
+
+bool SnapshotFile::Save(const std::string& path)
+{
+	auto runs = BuildRuns(CollectRanges());
+
+	Header header;
+	memset(&header, 0, sizeof(header));
+	header.Magic = Magic;
+	header.Version = Version;
+	header.PointerSize = sizeof(void*);
+	header.PageSize = PageSize;
+	header.NamesAddress = reinterpret_cast<uintptr_t>(NamesStore::GetAddress());
+	header.ObjectsAddress = reinterpret_cast<uintptr_t>(ObjectsStore::GetAddress());
+	header.RunsNum = runs.size();
+	header.RunsOffset = sizeof(Header);
+
+	auto offset = AlignUp(header.RunsOffset + runs.size() * sizeof(Run), PageSize);
+	for (auto&& run : runs)
+	{
+		run.Offset = offset;
+		offset += run.Size;
+	}
+
+	const auto file = path + "/" + FileName;
+	const auto fd = open(file.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+	if (fd < 0)
+	{
+		Logger::Log("Could not open %s: %s", file, strerror(errno));
+		return false;
+	}
+
+	//the pages are written straight from the process memory
+	auto success = WriteAll(fd, &header, sizeof(header), 0)
+		&& WriteAll(fd, runs.data(), runs.size() * sizeof(Run), header.RunsOffset);
+	for (auto i = 0u; success && i < runs.size(); ++i)
+	{
+		success = WriteAll(fd, reinterpret_cast<const void*>(runs[i].Address), runs[i].Size, runs[i].Offset);
+	}
+
+	close(fd);
+
+	if (!success)
+	{
+		Logger::Log("Could not write %s: %s", file, strerror(errno));
+		return false;
+	}
+
+	Logger::Log("Saved %d runs of reflection data to %s", runs.size(), file);
+
+	return true;
+}
+
+bool SnapshotFile::Load(const std::string& file, Header& header)
+{
+	const auto fd = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+	{
+		Logger::Log("Could not open %s: %s", file, strerror(errno));
+		return false;
+	}
+
+	const auto fail = [&](const char* reason)
+	{
+		Logger::Log("Could not load %s: %s", file, reason);
+		close(fd);
+		return false;
+	};
+
+	if (pread(fd, &header, sizeof(header), 0) != sizeof(header) || header.Magic != Magic)
+	{
+		return fail("not a snapshot file");
+	}
+	if (header.Version != Version)
+	{
+		return fail("unsupported version");
+	}
+	if (header.PointerSize != sizeof(void*))
+	{
+		return fail("the pointer size differs");
+	}
+	if (header.PageSize % sysconf(_SC_PAGESIZE) != 0)
+	{
+		return fail("the page size is not supported");
+	}
+
+	std::vector<Run> runs(header.RunsNum);
+	const auto runsSize = static_cast<ssize_t>(runs.size() * sizeof(Run));
+	if (pread(fd, runs.data(), runsSize, header.RunsOffset) != runsSize)
+	{
+		return fail("truncated file");
+	}
+
+	for (auto&& run : runs)
+	{
+		//private mappings, the generator never writes back into the file
+		const auto address = reinterpret_cast<void*>(run.Address);
+		const auto mapped = mmap(address, run.Size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED_NOREPLACE, fd, run.Offset);
+		if (mapped != address)
+		{
+			if (mapped != MAP_FAILED)
+			{
+				//kernels without MAP_FIXED_NOREPLACE treat the address as a hint
+				munmap(mapped, run.Size);
+			}
+			return fail("an address of the snapshot is already in use");
+		}
+	}
+
+	close(fd);
+
+	return true;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+/// <summary>
+/// Saves the memory the generator reads (the global names and objects stores, every object and the names of the enums)
+/// into one file and maps it back at the original addresses in another process.
+/// The pointers inside the captured memory stay valid, so the generator runs on a workstation against the data of a device.
+/// The file consists of a header, the table of the captured page runs and the pages, every run starts at a page aligned
+/// file offset so it can be mapped directly.
+/// </summary>
+class SnapshotFile
+{
+public:
+	/// <summary>The name of the snapshot file in the output directory.</summary>
+	static constexpr const char* FileName = "Reflection.snapshot";
+
+	/// <summary>"UESN" in little endian.</summary>
+	static constexpr uint32_t Magic = 0x4E534555;
+
+	/// <summary>Must be increased whenever the layout of the file or of the captured engine classes changes.</summary>
+	static constexpr uint32_t Version = 1;
+
+	/// <summary>The granularity of the captured memory.</summary>
+	static constexpr uint32_t PageSize = 4096;
+
+	struct Header
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		uint32_t PointerSize;
+		uint32_t PageSize;
+		uint64_t NamesAddress;
+		uint64_t ObjectsAddress;
+		uint64_t RunsNum;
+		/// <summary>File offset of the Run[RunsNum] array.</summary>
+		uint64_t RunsOffset;
+	};
+
+	/// <summary>Consecutive captured pages.</summary>
+	struct Run
+	{
+		uint64_t Address;
+		uint64_t Size;
+		/// <summary>File offset of the pages, a multiple of <see cref="PageSize" />.</summary>
+		uint64_t Offset;
+	};
+
+	/// <summary>
+	/// Captures the memory of the global stores and all objects into the snapshot file.
+	/// Must be called after <see cref="NamesStore::Initialize()" /> and <see cref="ObjectsStore::Initialize()" />.
+	/// </summary>
+	/// <param name="path">The output directory.</param>
+	/// <returns>true if it succeeds, false if it fails.</returns>
+	static bool Save(const std::string& path);
+
+	/// <summary>
+	/// Maps the pages of the snapshot file at their original addresses.
+	/// The mappings stay alive until the process ends.
+	/// </summary>
+	/// <param name="file">The snapshot file.</param>
+	/// <param name="header">[out] The header with the addresses of the global stores.</param>
+	/// <returns>true if it succeeds, false if the file is invalid or an address is already in use.</returns>
+	static bool Load(const std::string& file, Header& header);
+};
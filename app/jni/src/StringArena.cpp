@@ -0,0 +1,98 @@
+#include "StringArena.hpp"
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+StringArena::StringArena(size_t _blockSize)
+	: blockSize(_blockSize)
+{
+}
+
+std::string_view StringArena::Store(std::string_view value)
+{
+	if (value.empty())
+	{
+		return std::string_view();
+	}
+
+	const auto data = Allocate(value.size());
+	memcpy(data, value.data(), value.size());
+	return std::string_view(data, value.size());
+}
+
+std::string_view StringArena::Intern(std::string_view value)
+{
+	const auto it = interned.find(value);
+	if (it != std::end(interned))
+	{
+		return *it;
+	}
+
+	const auto stored = Store(value);
+	interned.insert(stored);
+	return stored;
+}
+
+std::string_view StringArena::Format(const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	va_list retry;
+	va_copy(retry, args);
+
+	//the first attempt writes into the rest of the current block, the terminator is not kept
+	const auto length = vsnprintf(current, remaining, format, args);
+	va_end(args);
+
+	std::string_view result;
+	if (length > 0)
+	{
+		if (static_cast<size_t>(length) < remaining)
+		{
+			result = std::string_view(current, length);
+			current += length;
+			remaining -= length;
+		}
+		else
+		{
+			const auto data = Allocate(length + 1);
+			vsnprintf(data, length + 1, format, retry);
+			result = std::string_view(data, length);
+
+			//give the terminator back
+			if (data + length + 1 == current)
+			{
+				--current;
+				++remaining;
+			}
+		}
+	}
+
+	va_end(retry);
+	return result;
+}
+
+char* StringArena::Allocate(size_t size)
+{
+	if (size > remaining)
+	{
+		if (size > blockSize / 4)
+		{
+			//a large string would waste the rest of the current block
+			blocks.emplace_back(std::make_unique<char[]>(size));
+			allocatedBytes += size;
+			return blocks.back().get();
+		}
+
+		blocks.emplace_back(std::make_unique<char[]>(blockSize));
+		allocatedBytes += blockSize;
+		current = blocks.back().get();
+		remaining = blockSize;
+	}
+
+	const auto data = current;
+	current += size;
+	remaining -= size;
+	return data;
+}
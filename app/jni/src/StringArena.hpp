@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+/// <summary>
+/// A monotonic allocator for strings. The strings are copied into large blocks and handed out as views which stay valid
+/// until the arena is destroyed; nothing is freed before, so storing a string costs a pointer bump instead of a malloc.
+/// Not thread safe, every package owns its own arena.
+/// </summary>
+class StringArena
+{
+public:
+	/// <param name="blockSize">The size of the blocks, larger strings get a block of their own.</param>
+	explicit StringArena(size_t blockSize = 64 * 1024);
+
+	StringArena(const StringArena&) = delete;
+	StringArena& operator=(const StringArena&) = delete;
+	StringArena(StringArena&&) = default;
+	StringArena& operator=(StringArena&&) = default;
+
+	/// <summary>Copies the string into the arena.</summary>
+	/// <returns>The view of the copy.</returns>
+	std::string_view Store(std::string_view value);
+
+	/// <summary>Copies the string into the arena unless an equal string was interned before.</summary>
+	/// <returns>The view of the interned string.</returns>
+	std::string_view Intern(std::string_view value);
+
+	/// <summary>Formats directly into the arena with printf semantics.</summary>
+	/// <returns>The view of the formatted string.</returns>
+	std::string_view Format(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+	/// <summary>Gets the number of bytes of all blocks.</summary>
+	size_t GetAllocatedBytes() const { return allocatedBytes; }
+
+private:
+	/// <summary>Reserves the bytes in the current block or a new one.</summary>
+	char* Allocate(size_t size);
+
+	size_t blockSize;
+	std::vector<std::unique_ptr<char[]>> blocks;
+	char* current = nullptr;
+	size_t remaining = 0;
+	size_t allocatedBytes = 0;
+
+	std::unordered_set<std::string_view> interned;
+};
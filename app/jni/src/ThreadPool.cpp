@@ -0,0 +1,112 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <memory>
+
+namespace
+{
+	struct WorkQueue
+	{
+		std::mutex Mutex;
+		std::deque<size_t> Tasks;
+
+		bool PopFront(size_t& task)
+		{
+			std::lock_guard<std::mutex> lock(Mutex);
+			if (Tasks.empty())
+			{
+				return false;
+			}
+			task = Tasks.front();
+			Tasks.pop_front();
+			return true;
+		}
+
+		bool PopBack(size_t& task)
+		{
+			std::lock_guard<std::mutex> lock(Mutex);
+			if (Tasks.empty())
+			{
+				return false;
+			}
+			task = Tasks.back();
+			Tasks.pop_back();
+			return true;
+		}
+	};
+}
+
+ThreadPool::ThreadPool(size_t _workers)
+	: workers(_workers != 0 ? _workers : std::thread::hardware_concurrency())
+{
+	if (workers == 0)
+	{
+		workers = 1;
+	}
+}
+
+void ThreadPool::Run(size_t count, const std::function<void(size_t)>& task) const
+{
+	const auto threadsNum = std::min(workers, count);
+	if (threadsNum <= 1)
+	{
+		for (auto i = 0u; i < count; ++i)
+		{
+			task(i);
+		}
+		return;
+	}
+
+	//every worker starts with a contiguous slice of the tasks
+	std::vector<std::unique_ptr<WorkQueue>> queues;
+	for (auto i = 0u; i < threadsNum; ++i)
+	{
+		queues.emplace_back(std::make_unique<WorkQueue>());
+	}
+	for (auto i = 0u; i < count; ++i)
+	{
+		queues[i * threadsNum / count]->Tasks.push_back(i);
+	}
+
+	const auto work = [&](size_t worker)
+	{
+		size_t index;
+		while (true)
+		{
+			if (queues[worker]->PopFront(index))
+			{
+				task(index);
+				continue;
+			}
+
+			auto stolen = false;
+			for (auto i = 1u; i < threadsNum && !stolen; ++i)
+			{
+				stolen = queues[(worker + i) % threadsNum]->PopBack(index);
+			}
+			if (!stolen)
+			{
+				//tasks never add new tasks, so all queues are drained
+				return;
+			}
+
+			task(index);
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (auto i = 1u; i < threadsNum; ++i)
+	{
+		threads.emplace_back(work, i);
+	}
+	work(0);
+
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+}
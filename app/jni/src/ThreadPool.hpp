@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+/// <summary>
+/// Runs a batch of independent tasks on all cores.
+/// Every worker owns a deque of task indices, works through it from the front and steals
+/// from the back of the other deques when it runs dry, so a few expensive tasks do not
+/// leave the other cores idle.
+/// </summary>
+class ThreadPool
+{
+public:
+	/// <summary>Constructor.</summary>
+	/// <param name="workers">The number of workers, 0 uses one worker per hardware thread.</param>
+	explicit ThreadPool(size_t workers = 0);
+
+	/// <summary>Gets the number of workers.</summary>
+	/// <returns>The number of workers.</returns>
+	size_t GetWorkersNum() const { return workers; }
+
+	/// <summary>Runs the task for every index in [0, count) and waits until all tasks are done.</summary>
+	/// <param name="count">The number of tasks.</param>
+	/// <param name="task">The task, called with the task index.</param>
+	void Run(size_t count, const std::function<void(size_t)>& task) const;
+
+private:
+	size_t workers;
+};
@@ -1,5 +1,12 @@
 #include "Tools.h"
 
+#include <cstring>
+
+#include <link.h>
+#include <elf.h>
+
+#include "ModuleMap.hpp"
+
 #if defined(__arm__)
 #define process_vm_readv_syscall 376
 #define process_vm_writev_syscall 377
@@ -36,6 +43,7 @@ bool pvm(void *address, void *buffer, size_t size, bool write = false) {
     ssize_t bytes = process_v(target_pid, local, 1, remote, 1, 0, write);
     return bytes == size;
 }
+
 bool Tools::Read(void *addr, void *buffer, size_t length) {
     return memcpy(buffer, addr, length) != 0;
 }
@@ -45,15 +53,27 @@ bool Tools::Write(void *addr, void *buffer, size_t length) {
 }
 
 bool Tools::ReadAddr(void *addr, void *buffer, size_t length) {
-    unsigned long page_size = sysconf(_SC_PAGESIZE);
-    unsigned long size = page_size * sizeof(uintptr_t);
-    return mprotect((void *) ((uintptr_t) addr - ((uintptr_t) addr % page_size) - page_size), (size_t) size, PROT_EXEC | PROT_READ | PROT_WRITE) == 0 && memcpy(buffer, addr, length) != 0;
+    return IsPtrValid(addr, length) && memcpy(buffer, addr, length) != 0;
 }
 
 bool Tools::WriteAddr(void *addr, void *buffer, size_t length) {
-    unsigned long page_size = sysconf(_SC_PAGESIZE);
-    unsigned long size = page_size * sizeof(uintptr_t);
-    return mprotect((void *) ((uintptr_t) addr - ((uintptr_t) addr % page_size) - page_size), (size_t) size, PROT_EXEC | PROT_READ | PROT_WRITE) == 0 && memcpy(addr, buffer, length) != 0;
+    int prot;
+    if (!ModuleMap::GetProtection((uintptr_t) addr, length, 0, prot)) {
+        return false;
+    }
+
+    // only read only pages are made writable
+    if (!(prot & PROT_WRITE)) {
+        unsigned long page_size = sysconf(_SC_PAGESIZE);
+        uintptr_t begin = (uintptr_t) addr - ((uintptr_t) addr % page_size);
+        uintptr_t end = (uintptr_t) addr + length;
+        if (mprotect((void *) begin, (size_t) (end - begin), PROT_EXEC | PROT_READ | PROT_WRITE) != 0) {
+            return false;
+        }
+        ModuleMap::Refresh();
+    }
+
+    return memcpy(addr, buffer, length) != 0;
 }
 
 bool Tools::PVM_ReadAddr(void *addr, void *buffer, size_t length) {
@@ -64,65 +84,66 @@ bool Tools::PVM_WriteAddr(void *addr, void *buffer, size_t length) {
     return pvm(addr, buffer, length, true);
 }
 
-bool Tools::IsPtrValid(void *addr) {
+ssize_t Tools::PVM_ReadV(pid_t pid, const struct iovec *local, unsigned long localCount, const struct iovec *remote, unsigned long remoteCount) {
+    return process_v(pid, local, localCount, remote, remoteCount, 0, false);
+}
+
+bool Tools::IsPtrValid(const void *addr, size_t length, bool refreshOnMiss) {
     if (!addr) {
         return false;
     }
-    static int fd = -1;
-    if (fd == -1) {
-        fd = open("/dev/random", O_WRONLY);
-    }
-    return write(fd, addr, 4) >= 0;
+    int prot;
+    return ModuleMap::GetProtection((uintptr_t) addr, length, PROT_READ, prot, refreshOnMiss);
 }
 
 uintptr_t Tools::GetBaseAddress(const char *name) {
-    uintptr_t base = 0;
-    char line[512];
-
-    FILE *f = fopen("/proc/self/maps", "r");
-
-    if (!f) {
-        return 0;
-    }
-
-    while (fgets(line, sizeof line, f)) {
-        uintptr_t tmpBase;
-        char tmpName[256];
-        if (sscanf(line, "%" PRIXPTR "-%*" PRIXPTR " %*s %*s %*s %*s %s", &tmpBase, tmpName) > 0) {
-            if (!strcmp(basename(tmpName), name)) {
-                base = tmpBase;
-                break;
-            }
-        }
-    }
-
-    fclose(f);
-    return base;
+    return ModuleMap::GetBaseAddress(name);
 }
 
 uintptr_t Tools::GetEndAddress(const char *name) {
-    uintptr_t end = 0;
-    char line[512];
+    return ModuleMap::GetEndAddress(name);
+}
 
-    FILE *f = fopen("/proc/self/maps", "r");
+std::string Tools::GetBuildId(const char *name) {
+    struct Search {
+        const char *name;
+        std::string buildId;
+    } search = { name, std::string() };
 
-    if (!f) {
-        return 0;
-    }
+    dl_iterate_phdr([](struct dl_phdr_info *info, size_t, void *data) -> int {
+        auto search = static_cast<Search *>(data);
+        if (!info->dlpi_name) {
+            return 0;
+        }
+        const auto slash = strrchr(info->dlpi_name, '/');
+        if (strcmp(slash != nullptr ? slash + 1 : info->dlpi_name, search->name) != 0) {
+            return 0;
+        }
 
-    while (fgets(line, sizeof line, f)) {
-        uintptr_t tmpEnd;
-        char tmpName[256];
-        if (sscanf(line, "%*" PRIXPTR "-%" PRIXPTR " %*s %*s %*s %*s %s", &tmpEnd, tmpName) > 0) {
-            if (!strcmp(basename(tmpName), name)) {
-                end = tmpEnd;
-            } else {
-                if (end)
-                    break;
+        for (auto i = 0; i < info->dlpi_phnum; ++i) {
+            const auto &phdr = info->dlpi_phdr[i];
+            if (phdr.p_type != PT_NOTE) {
+                continue;
+            }
+
+            auto note = reinterpret_cast<const uint8_t *>(info->dlpi_addr + phdr.p_vaddr);
+            const auto end = note + phdr.p_memsz;
+            while (note + sizeof(ElfW(Nhdr)) <= end) {
+                auto nhdr = reinterpret_cast<const ElfW(Nhdr) *>(note);
+                auto desc = note + sizeof(ElfW(Nhdr)) + ((nhdr->n_namesz + 3) & ~3u);
+                if (nhdr->n_type == NT_GNU_BUILD_ID && nhdr->n_namesz == 4 && !memcmp(note + sizeof(ElfW(Nhdr)), "GNU", 4)) {
+                    static const char digits[] = "0123456789abcdef";
+                    for (auto j = 0u; j < nhdr->n_descsz; ++j) {
+                        search->buildId += digits[desc[j] >> 4];
+                        search->buildId += digits[desc[j] & 0xF];
+                    }
+                    return 1;
+                }
+                note = desc + ((nhdr->n_descsz + 3) & ~3u);
             }
         }
-    }
+        return 1;
+    }, &search);
 
-    fclose(f);
-    return end;
+    return search.buildId;
 }
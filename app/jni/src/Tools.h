@@ -10,14 +10,24 @@ namespace Tools
 
     bool PVM_ReadAddr(void *addr, void *buffer, size_t length);
     bool PVM_WriteAddr(void *addr, void *buffer, size_t length);
+    // process_vm_readv without the libc wrapper, see MemoryReader for batched reads
+    ssize_t PVM_ReadV(pid_t pid, const struct iovec *local, unsigned long localCount, const struct iovec *remote, unsigned long remoteCount);
 
-    bool IsPtrValid(void *addr);
+    // true if [addr, addr + length) is readable, a binary search in the cached mappings of ModuleMap
+    // a miss refreshes the mappings at most once per ModuleMap::MinRefreshInterval, never without refreshOnMiss
+    bool IsPtrValid(const void *addr, size_t length = sizeof(void *), bool refreshOnMiss = true);
 
+    // first and last address of a loaded library, 0 if it is not loaded, see ModuleMap
     uintptr_t GetBaseAddress(const char *name);
     uintptr_t GetEndAddress(const char *name);
 
+    // hex encoded GNU build-id of the loaded library, empty if the library has none
+    std::string GetBuildId(const char *name);
+
     std::string RandomString(const int len);
+#ifdef __ANDROID__
     std::string GetPackageName(JNIEnv *env, jobject context);
+#endif
 
     std::string CalcMD5(std::string s);
     std::string CalcSHA256(std::string s);
@@ -3,9 +3,67 @@
 #include "../ObjectsStore.hpp"
 #include "../NamesStore.hpp"
 #include "../NameValidator.hpp"
+#include "../ReflectionSnapshot.hpp"
+#include "../ClassHierarchy.hpp"
 
 #include "../EngineClasses.hpp"
 
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace
+{
+	using Shape = ReflectionSnapshot::Shape;
+
+	/// <summary>Gets the snapshot row of the object if the snapshot captured the fields of the given shapes.</summary>
+	int32_t GetSnapshotRow(const UEObject& obj, Shape first, Shape last)
+	{
+		const auto row = obj.GetRow();
+		if (row != ReflectionSnapshot::NullRow)
+		{
+			const auto shape = ReflectionSnapshot().GetShape(row);
+			if (shape >= first && shape <= last)
+			{
+				return row;
+			}
+		}
+		return ReflectionSnapshot::NullRow;
+	}
+
+	int32_t GetObjectRow(const UEObject& obj) { return GetSnapshotRow(obj, Shape::Object, Shape::Property); }
+
+	int32_t GetFieldRow(const UEObject& obj) { return GetSnapshotRow(obj, Shape::Field, Shape::Property); }
+
+	int32_t GetStructRow(const UEObject& obj) { return GetSnapshotRow(obj, Shape::Struct, Shape::Function); }
+
+	int32_t GetPropertyRow(const UEObject& obj) { return GetSnapshotRow(obj, Shape::Property, Shape::Property); }
+
+	/// <summary>Creates the wrapper of a reference read from the snapshot, the wrapper carries the row of the referenced object.</summary>
+	template<typename T>
+	T FromRow(int32_t row)
+	{
+		const ReflectionSnapshot snapshot;
+		if (row < 0)
+		{
+			return T();
+		}
+		return T(snapshot.GetObject(row), snapshot.GetShape(row) != Shape::None ? row : UEObject::NoRow);
+	}
+
+	/// <summary>Compares the name of the object without creating a string.</summary>
+	bool HasName(const UEObject& obj, std::string_view name)
+	{
+		std::string buffer;
+		return obj.GetNameView(buffer) == name;
+	}
+}
+
+constexpr int32_t UEObject::NoRow;
+constexpr int32_t UEObject::UnresolvedRow;
+
 void* UEObject::GetAddress() const
 {
     return object;
@@ -13,6 +71,17 @@ void* UEObject::GetAddress() const
 
 UEObject UEObject::GetPackageObject() const
 {
+    const auto snapshotRow = GetObjectRow(*this);
+    if (snapshotRow != ReflectionSnapshot::NullRow)
+    {
+        const ReflectionSnapshot snapshot;
+        const auto packageRow = snapshot.GetPackage(snapshotRow);
+        if (packageRow != ReflectionSnapshot::ForeignRow)
+        {
+            return FromRow<UEObject>(packageRow);
+        }
+    }
+
     UEObject package(nullptr);
 
     for (auto outer = GetOuter(); outer.IsValid(); outer = outer.GetOuter())
@@ -25,6 +94,23 @@ UEObject UEObject::GetPackageObject() const
 
 std::string UEObject::GetFullName() const
 {
+    std::string buffer;
+    return std::string(GetFullNameView(buffer));
+}
+
+std::string_view UEObject::GetFullNameView(std::string& buffer) const
+{
+    const auto snapshotRow = GetObjectRow(*this);
+    if (snapshotRow != ReflectionSnapshot::NullRow)
+    {
+        const ReflectionSnapshot snapshot;
+        const auto fullName = snapshot.GetFullName(snapshotRow);
+        if (fullName.data() != nullptr)
+        {
+            return snapshot.GetClass(snapshotRow) != ReflectionSnapshot::NullRow ? fullName : std::string_view("(null)");
+        }
+    }
+
     if (GetClass().IsValid())
     {
         std::string temp;
@@ -34,15 +120,15 @@ std::string UEObject::GetFullName() const
             temp = outer.GetName() + "." + temp;
         }
 
-        std::string name = GetClass().GetName();
-        name += " ";
-        name += temp;
-        name += GetName();
+        buffer = GetClass().GetName();
+        buffer += " ";
+        buffer += temp;
+        buffer += GetName();
 
-        return name;
+        return buffer;
     }
 
-    return std::string("(null)");
+    return std::string_view("(null)");
 }
 
 std::string UEObject::GetNameCPP() const
@@ -54,13 +140,12 @@ std::string UEObject::GetNameCPP() const
         auto c = Cast<UEClass>();
         while (c.IsValid())
         {
-            const auto className = c.GetName();
-            if (className == "Actor")
+            if (HasName(c, "Actor"))
             {
                 name += "A";
                 break;
             }
-            if (className == "Object")
+            if (HasName(c, "Object"))
             {
                 name += "U";
                 break;
@@ -74,125 +159,217 @@ std::string UEObject::GetNameCPP() const
         name += "F";
     }
 
-    name += GetName();
+    std::string buffer;
+    name += GetNameView(buffer);
 
     return name;
 }
 
+namespace
+{
+	using PropertyKind = UEProperty::PropertyKind;
+
+	/// <summary>
+	/// Maps the property classes to their kind. Every class is resolved once, the kinds of the classes the snapshot
+	/// captured are stored by row, the few others in a locked map.
+	/// </summary>
+	class PropertyKindTable
+	{
+	public:
+		PropertyKindTable()
+			: rowsNum(ReflectionSnapshot().GetRowsNum()),
+			  rowKinds(new std::atomic<uint8_t>[rowsNum]())
+		{
+			cascade = {
+				UEByteProperty::StaticClass(),
+				UEUInt16Property::StaticClass(),
+				UEUInt32Property::StaticClass(),
+				UEUInt64Property::StaticClass(),
+				UEInt8Property::StaticClass(),
+				UEInt16Property::StaticClass(),
+				UEIntProperty::StaticClass(),
+				UEInt64Property::StaticClass(),
+				UEFloatProperty::StaticClass(),
+				UEDoubleProperty::StaticClass(),
+				UEBoolProperty::StaticClass(),
+				UEObjectProperty::StaticClass(),
+				UEClassProperty::StaticClass(),
+				UEInterfaceProperty::StaticClass(),
+				UEWeakObjectProperty::StaticClass(),
+				UELazyObjectProperty::StaticClass(),
+				UEAssetObjectProperty::StaticClass(),
+				UEAssetClassProperty::StaticClass(),
+				UENameProperty::StaticClass(),
+				UEStructProperty::StaticClass(),
+				UEStrProperty::StaticClass(),
+				UETextProperty::StaticClass(),
+				UEArrayProperty::StaticClass(),
+				UEMapProperty::StaticClass(),
+				UEDelegateProperty::StaticClass(),
+				UEMulticastDelegateProperty::StaticClass(),
+				UEEnumProperty::StaticClass()
+			};
+
+			for (auto& cls : cascade)
+			{
+				if (cls.IsValid())
+				{
+					kinds.emplace_back(cls.GetAddress(), Resolve(cls));
+				}
+			}
+		}
+
+		PropertyKind Find(const UEClass& cls) const
+		{
+			//0 marks a class which is not resolved yet, so the kinds are stored plus one
+			const auto row = cls.GetRow();
+			if (row != UEObject::NoRow && static_cast<size_t>(row) < rowsNum)
+			{
+				const auto cached = rowKinds[row].load(std::memory_order_relaxed);
+				if (cached != 0)
+				{
+					return static_cast<PropertyKind>(cached - 1);
+				}
+
+				const auto kind = Lookup(cls);
+				rowKinds[row].store(static_cast<uint8_t>(kind) + 1, std::memory_order_relaxed);
+				return kind;
+			}
+
+			std::lock_guard<std::mutex> lock(mutex);
+
+			const auto it = uncaptured.find(cls.GetAddress());
+			if (it != std::end(uncaptured))
+			{
+				return it->second;
+			}
+
+			const auto kind = Lookup(cls);
+			uncaptured.emplace(cls.GetAddress(), kind);
+			return kind;
+		}
+
+	private:
+		PropertyKind Lookup(const UEClass& cls) const
+		{
+			for (auto& kind : kinds)
+			{
+				if (kind.first == cls.GetAddress())
+				{
+					return kind.second;
+				}
+			}
+
+			//a property class which is not one of the engine classes (derived by the game)
+			return Resolve(cls);
+		}
+
+		/// <summary>Gets the first kind (in the order of the enum) the class derives from.</summary>
+		PropertyKind Resolve(const UEClass& cls) const
+		{
+			for (size_t i = 0; i < cascade.size(); ++i)
+			{
+				if (!cascade[i].IsValid())
+				{
+					continue;
+				}
+
+				for (auto super = cls; super.IsValid(); super = super.GetSuper().Cast<UEClass>())
+				{
+					if (super.GetAddress() == cascade[i].GetAddress())
+					{
+						return static_cast<PropertyKind>(i + 1);
+					}
+				}
+			}
+
+			return PropertyKind::Unknown;
+		}
+
+		std::array<UEClass, static_cast<size_t>(PropertyKind::Enum)> cascade;
+		std::vector<std::pair<void*, PropertyKind>> kinds;
+
+		size_t rowsNum;
+		std::unique_ptr<std::atomic<uint8_t>[]> rowKinds;
+
+		mutable std::mutex mutex;
+		mutable std::unordered_map<void*, PropertyKind> uncaptured;
+	};
+}
+
+UEProperty::PropertyKind UEProperty::GetKind() const
+{
+	static const PropertyKindTable table;
+
+	if (!IsValid())
+	{
+		return PropertyKind::Unknown;
+	}
+
+	return table.Find(GetClass());
+}
+
 UEProperty::Info UEProperty::GetInfo() const
 {
-    if (IsValid())
-    {
-        if (IsA<UEByteProperty>())
-        {
-            return Cast<UEByteProperty>().GetInfo();
-        }
-        if (IsA<UEUInt16Property>())
-        {
-            return Cast<UEUInt16Property>().GetInfo();
-        }
-        if (IsA<UEUInt32Property>())
-        {
-            return Cast<UEUInt32Property>().GetInfo();
-        }
-        if (IsA<UEUInt64Property>())
-        {
-            return Cast<UEUInt64Property>().GetInfo();
-        }
-        if (IsA<UEInt8Property>())
-        {
-            return Cast<UEInt8Property>().GetInfo();
-        }
-        if (IsA<UEInt16Property>())
-        {
-            return Cast<UEInt16Property>().GetInfo();
-        }
-        if (IsA<UEIntProperty>())
-        {
-            return Cast<UEIntProperty>().GetInfo();
-        }
-        if (IsA<UEInt64Property>())
-        {
-            return Cast<UEInt64Property>().GetInfo();
-        }
-        if (IsA<UEFloatProperty>())
-        {
-            return Cast<UEFloatProperty>().GetInfo();
-        }
-        if (IsA<UEDoubleProperty>())
-        {
-            return Cast<UEDoubleProperty>().GetInfo();
-        }
-        if (IsA<UEBoolProperty>())
-        {
-            return Cast<UEBoolProperty>().GetInfo();
-        }
-        if (IsA<UEObjectProperty>())
-        {
-            return Cast<UEObjectProperty>().GetInfo();
-        }
-        if (IsA<UEClassProperty>())
-        {
-            return Cast<UEClassProperty>().GetInfo();
-        }
-        if (IsA<UEInterfaceProperty>())
-        {
-            return Cast<UEInterfaceProperty>().GetInfo();
-        }
-        if (IsA<UEWeakObjectProperty>())
-        {
-            return Cast<UEWeakObjectProperty>().GetInfo();
-        }
-        if (IsA<UELazyObjectProperty>())
-        {
-            return Cast<UELazyObjectProperty>().GetInfo();
-        }
-        if (IsA<UEAssetObjectProperty>())
-        {
-            return Cast<UEAssetObjectProperty>().GetInfo();
-        }
-        if (IsA<UEAssetClassProperty>())
-        {
-            return Cast<UEAssetClassProperty>().GetInfo();
-        }
-        if (IsA<UENameProperty>())
-        {
-            return Cast<UENameProperty>().GetInfo();
-        }
-        if (IsA<UEStructProperty>())
-        {
-            return Cast<UEStructProperty>().GetInfo();
-        }
-        if (IsA<UEStrProperty>())
-        {
-            return Cast<UEStrProperty>().GetInfo();
-        }
-        if (IsA<UETextProperty>())
-        {
-            return Cast<UETextProperty>().GetInfo();
-        }
-        if (IsA<UEArrayProperty>())
-        {
-            return Cast<UEArrayProperty>().GetInfo();
-        }
-        if (IsA<UEMapProperty>())
-        {
-            return Cast<UEMapProperty>().GetInfo();
-        }
-        if (IsA<UEDelegateProperty>())
-        {
-            return Cast<UEDelegateProperty>().GetInfo();
-        }
-        if (IsA<UEMulticastDelegateProperty>())
-        {
-            return Cast<UEMulticastDelegateProperty>().GetInfo();
-        }
-        if (IsA<UEEnumProperty>())
-        {
-            return Cast<UEEnumProperty>().GetInfo();
-        }
-    }
-    return { PropertyType::Unknown };
+	switch (GetKind())
+	{
+	case PropertyKind::Byte:
+		return Cast<UEByteProperty>().GetInfo();
+	case PropertyKind::UInt16:
+		return Cast<UEUInt16Property>().GetInfo();
+	case PropertyKind::UInt32:
+		return Cast<UEUInt32Property>().GetInfo();
+	case PropertyKind::UInt64:
+		return Cast<UEUInt64Property>().GetInfo();
+	case PropertyKind::Int8:
+		return Cast<UEInt8Property>().GetInfo();
+	case PropertyKind::Int16:
+		return Cast<UEInt16Property>().GetInfo();
+	case PropertyKind::Int:
+		return Cast<UEIntProperty>().GetInfo();
+	case PropertyKind::Int64:
+		return Cast<UEInt64Property>().GetInfo();
+	case PropertyKind::Float:
+		return Cast<UEFloatProperty>().GetInfo();
+	case PropertyKind::Double:
+		return Cast<UEDoubleProperty>().GetInfo();
+	case PropertyKind::Bool:
+		return Cast<UEBoolProperty>().GetInfo();
+	case PropertyKind::Object:
+		return Cast<UEObjectProperty>().GetInfo();
+	case PropertyKind::Class:
+		return Cast<UEClassProperty>().GetInfo();
+	case PropertyKind::Interface:
+		return Cast<UEInterfaceProperty>().GetInfo();
+	case PropertyKind::WeakObject:
+		return Cast<UEWeakObjectProperty>().GetInfo();
+	case PropertyKind::LazyObject:
+		return Cast<UELazyObjectProperty>().GetInfo();
+	case PropertyKind::AssetObject:
+		return Cast<UEAssetObjectProperty>().GetInfo();
+	case PropertyKind::AssetClass:
+		return Cast<UEAssetClassProperty>().GetInfo();
+	case PropertyKind::Name:
+		return Cast<UENameProperty>().GetInfo();
+	case PropertyKind::Struct:
+		return Cast<UEStructProperty>().GetInfo();
+	case PropertyKind::Str:
+		return Cast<UEStrProperty>().GetInfo();
+	case PropertyKind::Text:
+		return Cast<UETextProperty>().GetInfo();
+	case PropertyKind::Array:
+		return Cast<UEArrayProperty>().GetInfo();
+	case PropertyKind::Map:
+		return Cast<UEMapProperty>().GetInfo();
+	case PropertyKind::Delegate:
+		return Cast<UEDelegateProperty>().GetInfo();
+	case PropertyKind::MulticastDelegate:
+		return Cast<UEMulticastDelegateProperty>().GetInfo();
+	case PropertyKind::Enum:
+		return Cast<UEEnumProperty>().GetInfo();
+	default:
+		return { PropertyType::Unknown };
+	}
 }
 
 //---------------------------------------------------------------------------
@@ -251,34 +428,102 @@ std::array<int, 2> UEBoolProperty::GetMissingBitsCount(const UEBoolProperty& oth
 //---------------------------------------------------------------------------
 size_t UEObject::GetIndex() const
 {
+	//the row of a captured object is its index in the store
+	const auto snapshotRow = GetRow();
+	if (snapshotRow != NoRow)
+	{
+		return snapshotRow;
+	}
+
 	return object->InternalIndex;
 }
 //---------------------------------------------------------------------------
+int32_t UEObject::GetRow() const
+{
+	if (row == UnresolvedRow)
+	{
+		return ReflectionSnapshot().GetRow(object);
+	}
+
+	return row;
+}
+//---------------------------------------------------------------------------
 UEClass UEObject::GetClass() const
 {
+	const auto snapshotRow = GetObjectRow(*this);
+	if (snapshotRow != ReflectionSnapshot::NullRow)
+	{
+		const ReflectionSnapshot snapshot;
+		return FromRow<UEClass>(snapshot.GetClass(snapshotRow));
+	}
+
 	return UEClass(object->ClassPrivate);
 }
 //---------------------------------------------------------------------------
 UEObject UEObject::GetOuter() const
 {
+	const auto snapshotRow = GetObjectRow(*this);
+	if (snapshotRow != ReflectionSnapshot::NullRow)
+	{
+		const ReflectionSnapshot snapshot;
+		return FromRow<UEObject>(snapshot.GetOuter(snapshotRow));
+	}
+
 	return UEObject(object->OuterPrivate);
 }
 //---------------------------------------------------------------------------
+bool UEObject::IsA(const UEClass& cmp) const
+{
+	const auto cls = GetClass();
+	if (!cls.IsValid())
+	{
+		return false;
+	}
+
+	const ClassHierarchy hierarchy;
+	const auto id = hierarchy.GetId(cls);
+	const auto baseId = hierarchy.GetId(cmp);
+	if (id != ClassHierarchy::InvalidId && baseId != ClassHierarchy::InvalidId)
+	{
+		return hierarchy.IsChildOf(id, baseId);
+	}
+
+	for (auto super = cls; super.IsValid(); super = super.GetSuper().Cast<UEClass>())
+	{
+		if (super.object == cmp.object)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+//---------------------------------------------------------------------------
 std::string UEObject::GetName() const
 {
-	auto name = NamesStore().GetById(object->NamePrivate.ComparisonIndex);
-	if (object->NamePrivate.Number > 0)
+	std::string buffer;
+	return std::string(GetNameView(buffer));
+}
+//---------------------------------------------------------------------------
+std::string_view UEObject::GetNameView(std::string& buffer) const
+{
+	const auto snapshotRow = GetObjectRow(*this);
+	if (snapshotRow != ReflectionSnapshot::NullRow)
 	{
-		name += '_' + std::to_string(object->NamePrivate.Number);
+		return ReflectionSnapshot().GetName(snapshotRow);
 	}
 
-	auto pos = name.rfind('/');
-	if (pos == std::string::npos)
+	//the number suffix never contains a '/', so the path can be stripped first
+	const auto name = NamesStore().GetShortViewById(object->NamePrivate.ComparisonIndex);
+	if (object->NamePrivate.Number > 0)
 	{
-		return name;
+		buffer.assign(name.data(), name.size());
+		buffer += '_';
+		buffer += std::to_string(object->NamePrivate.Number);
+		return buffer;
 	}
 
-	return name.substr(pos + 1);
+	return name;
 }
 //---------------------------------------------------------------------------
 UEClass UEObject::StaticClass()
@@ -291,6 +536,13 @@ UEClass UEObject::StaticClass()
 //---------------------------------------------------------------------------
 UEField UEField::GetNext() const
 {
+	const auto snapshotRow = GetFieldRow(*this);
+	if (snapshotRow != ReflectionSnapshot::NullRow)
+	{
+		const ReflectionSnapshot snapshot;
+		return FromRow<UEField>(snapshot.GetNext(snapshotRow));
+	}
+
 	return UEField(static_cast<UField*>(object)->Next);
 }
 //---------------------------------------------------------------------------
@@ -338,16 +590,36 @@ UEClass UEConst::StaticClass()
 //---------------------------------------------------------------------------
 UEStruct UEStruct::GetSuper() const
 {
+	const auto snapshotRow = GetStructRow(*this);
+	if (snapshotRow != ReflectionSnapshot::NullRow)
+	{
+		const ReflectionSnapshot snapshot;
+		return FromRow<UEStruct>(snapshot.GetSuper(snapshotRow));
+	}
+
 	return UEStruct(static_cast<UStruct*>(object)->SuperStruct);
 }
 //---------------------------------------------------------------------------
 UEField UEStruct::GetChildren() const
 {
+	const auto snapshotRow = GetStructRow(*this);
+	if (snapshotRow != ReflectionSnapshot::NullRow)
+	{
+		const ReflectionSnapshot snapshot;
+		return FromRow<UEField>(snapshot.GetChildren(snapshotRow));
+	}
+
 	return UEField(static_cast<UStruct*>(object)->Children);
 }
 //---------------------------------------------------------------------------
 size_t UEStruct::GetPropertySize() const
 {
+	const auto snapshotRow = GetStructRow(*this);
+	if (snapshotRow != ReflectionSnapshot::NullRow)
+	{
+		return ReflectionSnapshot().GetPropertySize(snapshotRow);
+	}
+
 	return static_cast<UStruct*>(object)->PropertySize;
 }
 //---------------------------------------------------------------------------
@@ -369,6 +641,12 @@ UEClass UEScriptStruct::StaticClass()
 //---------------------------------------------------------------------------
 UEFunctionFlags UEFunction::GetFunctionFlags() const
 {
+	const auto snapshotRow = GetSnapshotRow(*this, Shape::Function, Shape::Function);
+	if (snapshotRow != ReflectionSnapshot::NullRow)
+	{
+		return static_cast<UEFunctionFlags>(ReflectionSnapshot().GetFunctionFlags(snapshotRow));
+	}
+
 	return static_cast<UEFunctionFlags>(static_cast<UFunction*>(object)->FunctionFlags);
 }
 //---------------------------------------------------------------------------
@@ -390,21 +668,45 @@ UEClass UEClass::StaticClass()
 //---------------------------------------------------------------------------
 size_t UEProperty::GetArrayDim() const
 {
+	const auto snapshotRow = GetPropertyRow(*this);
+	if (snapshotRow != ReflectionSnapshot::NullRow)
+	{
+		return ReflectionSnapshot().GetArrayDim(snapshotRow);
+	}
+
 	return static_cast<UProperty*>(object)->ArrayDim;
 }
 //---------------------------------------------------------------------------
 size_t UEProperty::GetElementSize() const
 {
+	const auto snapshotRow = GetPropertyRow(*this);
+	if (snapshotRow != ReflectionSnapshot::NullRow)
+	{
+		return ReflectionSnapshot().GetElementSize(snapshotRow);
+	}
+
 	return static_cast<UProperty*>(object)->ElementSize;
 }
 //---------------------------------------------------------------------------
 UEPropertyFlags UEProperty::GetPropertyFlags() const
 {
+	const auto snapshotRow = GetPropertyRow(*this);
+	if (snapshotRow != ReflectionSnapshot::NullRow)
+	{
+		return static_cast<UEPropertyFlags>(ReflectionSnapshot().GetPropertyFlags(snapshotRow));
+	}
+
 	return static_cast<UEPropertyFlags>(static_cast<UProperty*>(object)->PropertyFlags.A);
 }
 //---------------------------------------------------------------------------
 size_t UEProperty::GetOffset() const
 {
+	const auto snapshotRow = GetPropertyRow(*this);
+	if (snapshotRow != ReflectionSnapshot::NullRow)
+	{
+		return ReflectionSnapshot().GetOffset(snapshotRow);
+	}
+
 	return static_cast<UProperty*>(object)->Offset;
 }
 //---------------------------------------------------------------------------
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <array>
 
@@ -14,12 +15,28 @@ class UEClass;
 class UEObject
 {
 public:
+	/// <summary>The row of an object which the reflection snapshot did not capture.</summary>
+	static constexpr int32_t NoRow = -1;
+
+	/// <summary>The row of an object which was created from a bare pointer, it is looked up by the address.</summary>
+	static constexpr int32_t UnresolvedRow = -3;
+
 	UEObject()
-		: object(nullptr)
+		: object(nullptr),
+		  row(NoRow)
 	{
 	}
 	UEObject(UObject *_object)
-		: object(_object)
+		: object(_object),
+		  row(_object != nullptr ? UnresolvedRow : NoRow)
+	{
+	}
+	/// <summary>Creates the wrapper of an object whose row in the reflection snapshot is known.</summary>
+	/// <param name="_object">The object.</param>
+	/// <param name="_row">The row or <see cref="NoRow" /> if the object is not captured.</param>
+	UEObject(UObject *_object, int32_t _row)
+		: object(_object),
+		  row(_row)
 	{
 	}
 
@@ -36,27 +53,52 @@ public:
 
 	std::string GetName() const;
 
+	/// <summary>
+	/// Gets the name without a copy, from the reflection snapshot or the names table (<see cref="NamesStore::GetShortViewById" />).
+	/// </summary>
+	/// <param name="buffer">[in,out] Holds the name if it has to be composed (an object with a number which is not captured).</param>
+	/// <returns>The name, valid as long as the buffer is not changed.</returns>
+	std::string_view GetNameView(std::string& buffer) const;
+
 	std::string GetFullName() const;
 
+	/// <summary>Gets the full name without a copy if the reflection snapshot captured the object.</summary>
+	/// <param name="buffer">[in,out] Holds the full name of an object which is not captured.</param>
+	/// <returns>The full name, valid as long as the buffer is not changed.</returns>
+	std::string_view GetFullNameView(std::string& buffer) const;
+
 	std::string GetNameCPP() const;
 
 	UEObject GetPackageObject() const;
 
 	void* GetAddress() const;
 
+	/// <summary>
+	/// Gets the row of the object in the reflection snapshot. The objects of the store and the objects read from the
+	/// snapshot carry their row, only the wrappers of bare pointers search it by the address.
+	/// </summary>
+	/// <returns>The row or <see cref="NoRow" /> if the object is not captured.</returns>
+	int32_t GetRow() const;
+
 	template<typename Base>
 	Base Cast() const
 	{
-		return Base(object);
+		return Base(object, row);
 	}
 
 	template<typename T>
 	bool IsA() const;
 
+	/// <summary>Checks if the class of the object derives from (or is) the given class.</summary>
+	/// <param name="cmp">The class to check against.</param>
+	/// <returns>true if the object is an instance of the class.</returns>
+	bool IsA(const UEClass& cmp) const;
+
 	static UEClass StaticClass();
 
 protected:
 	UObject* object;
+	int32_t row;
 };
 
 namespace std
@@ -181,6 +223,46 @@ public:
 		}
 	};
 
+	/// <summary>
+	/// The type of a property, resolved from the exact class of the property.
+	/// The order matches the order in which <see cref="GetInfo()" /> tests the property classes.
+	/// </summary>
+	enum class PropertyKind : uint8_t
+	{
+		Unknown,
+		Byte,
+		UInt16,
+		UInt32,
+		UInt64,
+		Int8,
+		Int16,
+		Int,
+		Int64,
+		Float,
+		Double,
+		Bool,
+		Object,
+		Class,
+		Interface,
+		WeakObject,
+		LazyObject,
+		AssetObject,
+		AssetClass,
+		Name,
+		Struct,
+		Str,
+		Text,
+		Array,
+		Map,
+		Delegate,
+		MulticastDelegate,
+		Enum
+	};
+
+	/// <summary>Gets the kind of the property with a lookup of the property class.</summary>
+	/// <returns>The kind or <see cref="PropertyKind::Unknown" />.</returns>
+	PropertyKind GetKind() const;
+
 	Info GetInfo() const;
 
 	static UEClass StaticClass();
@@ -530,13 +612,5 @@ bool UEObject::IsA() const
 		return false;
 	}
 
-	for (auto super = GetClass(); super.IsValid(); super = super.GetSuper().Cast<UEClass>())
-	{
-		if (super.object == cmp.object)
-		{
-			return true;
-		}
-	}
-
-	return false;
+	return IsA(cmp);
 }
@@ -21,6 +21,7 @@
 #include <functional>
 #include <iterator>
 #include <list>
+#include <limits>
 #include <map>
 #include <numeric>
 #include <set>